@@ -100,6 +100,43 @@ M.register('-p', '--preserve', 0, function() end, 'Preserve ^Q (XON) and ^S (XOF
 M.register('-L', '--lua', 1, function() end, 'Runs the given file as a Lua script and exits')
 M.register('-T', '--cov', 0, function() end, 'Runs unit tests with code coverage')
 
+-- Profiles event handlers, writing their statistics to the given file on quit.
+M.register('-P', '--profile-events', 1, function(filename)
+	filename = lfs.abspath(filename, arg[-1] or lfs.currentdir())
+	events.profile()
+	events.connect(events.QUIT, function()
+		local f<close> = assert(io.open(filename, 'wb'))
+		f:write('event,handler,calls,time,max_time,bytes\n')
+		for _, stat in ipairs(events.stats()) do
+			f:write(string.format('%s,%s,%d,%.9f,%.9f,%d\n', stat.event, stat.handler, stat.calls,
+				stat.time, stat.max_time, stat.bytes))
+		end
+	end)
+end, 'Writes event handler statistics to the given file on quit')
+
+-- Records emitted events to the given trace file.
+M.register('-r', '--record', 1, function(filename)
+	events.record(lfs.abspath(filename, arg[-1] or lfs.currentdir()))
+end, 'Records emitted events to the given trace file')
+
+-- Replays the given trace file and prints event latencies on the command line.
+M.register('-R', '--replay', 1, function(filename)
+	local stats = assert(events.replay(lfs.abspath(filename, arg[-1] or lfs.currentdir())))
+	if CURSES then return end -- not supported
+	local names = {}
+	for name in pairs(stats) do names[#names + 1] = name end
+	table.sort(names)
+	print(string.format('%-24s %8s %10s %10s %10s %10s', 'event', 'count', 'p50 ms', 'p90 ms',
+		'p99 ms', 'max ms'))
+	for _, name in ipairs(names) do
+		local stat = stats[name]
+		print(string.format('%-24s %8d %10.3f %10.3f %10.3f %10.3f', name, stat.count,
+			stat.p50 * 1000, stat.p90 * 1000, stat.p99 * 1000, stat.max * 1000))
+	end
+	timeout(0.01, function() quit(0, false) end)
+	return true
+end, 'Replays the given trace file, prints event latencies, and quits')
+
 -- Shows all registered command line options on the command line.
 M.register('-h', '--help', 0, function()
 	if CURSES then return end -- not supported
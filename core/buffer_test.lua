@@ -30,6 +30,244 @@ test('read/write-only properties should raise errors at the appropriate times',
 	test.assert_raises(write_only_property, 'write-only property')
 end)
 
+test('buffer and view functions should be looked up once and shared', function()
+	local get_text = buffer.get_text
+
+	test.assert_equal(buffer.get_text, get_text)
+	test.assert_equal(view.get_text, get_text)
+end)
+
+test('buffer function lookups should not allocate memory', function()
+	local f = buffer.line_from_position -- prime the cache
+	collectgarbage('stop')
+	local before = collectgarbage('count')
+	for _ = 1, 1000 do f = buffer.line_from_position end
+	local after = collectgarbage('count')
+	collectgarbage('restart')
+
+	test.assert_equal(after, before)
+end)
+
+test('_SCINTILLA should still provide interface tables for functions and properties', function()
+	local names = {}
+	for k, v in pairs(_SCINTILLA) do if type(v) == 'table' then names[k] = #v end end
+
+	test.assert_equal(_SCINTILLA.get_text, {2182, 0, 2, 8})
+	test.assert_equal(_SCINTILLA.x_offset, {2398, 2397, 1, 0, 0})
+	test.assert_equal(_SCINTILLA.unknown, nil)
+	test.assert_equal(names.get_text, 4)
+	test.assert_equal(names.style_at, 5)
+end)
+
+test('_SCINTILLA.stats should record Scintilla calls while profiling', function()
+	_SCINTILLA.reset_stats()
+	_SCINTILLA.profile()
+	local _<close> = test.defer(function() _SCINTILLA.profile(false) end)
+
+	buffer:append_text('text')
+	buffer.line_state[1] = 1
+
+	local stats = {}
+	for _, stat in ipairs(_SCINTILLA.stats()) do stats[stat.name] = stat end
+	test.assert_equal(stats.append_text.calls, 1)
+	test.assert_equal(stats.append_text.bytes, #'text')
+	test.assert(stats.append_text.time >= 0, 'should have recorded time')
+	test.assert_equal(stats['line_state='].calls, 1)
+end)
+
+test('_SCINTILLA.dump_stats should write call statistics to CSV or JSON', function()
+	_SCINTILLA.reset_stats()
+	_SCINTILLA.profile()
+	buffer:append_text('text')
+	_SCINTILLA.profile(false)
+	local csv<close> = test.tmpfile('.csv')
+	local json<close> = test.tmpfile('.json')
+
+	_SCINTILLA.dump_stats(csv.filename)
+	_SCINTILLA.dump_stats(json.filename)
+
+	test.assert(csv:read():find('^name,calls,time,bytes\n'), 'csv header expected')
+	test.assert(csv:read():find('\nappend_text,1,[%d.]+,4\n'), 'csv row expected')
+	test.assert(json:read():find('"name": "append_text", "calls": 1'), 'json expected')
+end)
+
+test('indexable buffer and view properties should be looked up once per buffer/view', function()
+	local buffer1 = buffer
+	buffer.new()
+
+	test.assert_equal(buffer.style_at, buffer.style_at)
+	test.assert_equal(view.marker_fore, view.marker_fore)
+	test.assert(buffer.style_at ~= buffer1.style_at, 'properties should not be shared')
+end)
+
+test('indexable property reads should not allocate memory', function()
+	buffer:append_text('text')
+	local style_at, style = buffer.style_at, nil
+	collectgarbage('stop')
+	local before = collectgarbage('count')
+	for pos = 1, 1000 do style = buffer.style_at[pos % 4 + 1] end
+	local after = collectgarbage('count')
+	collectgarbage('restart')
+
+	test.assert_equal(after, before)
+	test.assert_equal(style, style_at[1])
+end)
+
+test('buffer.styles_in_range should return the styles of a range of text', function()
+	buffer:append_text('local x = "x"')
+	buffer:set_lexer('lua')
+	buffer:colorize(1, -1)
+
+	local styles = buffer:styles_in_range(1, buffer.length + 1)
+
+	test.assert_equal(#styles, buffer.length)
+	for pos = 1, buffer.length do test.assert_equal(styles[pos], buffer.style_at[pos]) end
+	test.assert_equal(buffer:styles_in_range(5, 5), {})
+	test.assert_equal(#buffer:styles_in_range(1, math.maxinteger), buffer.length)
+	test.assert_raises(function() buffer:styles_in_range(-1, 5) end, 'position out of range')
+end)
+
+test('buffer.style_run should return the range of text with the same style as a position',
+	function()
+		buffer:append_text('local x = "x"')
+		buffer:set_lexer('lua')
+		buffer:colorize(1, -1)
+
+		local s, e = buffer:style_run(3)
+		local string_s, string_e = buffer:style_run(buffer.length)
+
+		test.assert_equal({s, e}, {1, 6})
+		test.assert_equal({string_s, string_e}, {11, buffer.length + 1})
+	end)
+
+test('buffer.line_states and buffer.fold_levels should return per-line values', function()
+	buffer:append_text(test.lines{'if true then', '\tx = 1', 'end'})
+	buffer:set_lexer('lua')
+	buffer:colorize(1, -1)
+
+	local fold_levels = buffer:fold_levels()
+	local line_states = buffer:line_states(2, 3)
+
+	test.assert_equal(#fold_levels, buffer.line_count)
+	for line = 1, buffer.line_count do
+		test.assert_equal(fold_levels[line], buffer.fold_level[line])
+	end
+	test.assert_equal(line_states, {buffer.line_state[2], buffer.line_state[3]})
+end)
+
+test('buffer.indicator_ranges should return the ranges of an indicator', function()
+	buffer:append_text('one two three')
+	buffer.indicator_current = 1
+	buffer:indicator_fill_range(1, 3)
+	buffer:indicator_fill_range(9, 5)
+
+	local ranges = buffer:indicator_ranges(1)
+	local partial_ranges = buffer:indicator_ranges(1, 2, 11)
+
+	test.assert_equal(ranges, {1, 4, 9, 14})
+	test.assert_equal(partial_ranges, {2, 4, 9, 11})
+end)
+
+test('buffer.text_view should provide read-only access to text without copying it', function()
+	buffer:append_text('one two three')
+
+	local text = buffer:text_view()
+	local range = buffer:text_view(5, 8)
+
+	test.assert_equal(#text, buffer.length)
+	test.assert_equal(tostring(text), buffer:get_text())
+	test.assert_equal(tostring(range), 'two')
+	test.assert_equal(range:sub(2), 'wo')
+	test.assert_equal(range:sub(-2, -2), 'w')
+	test.assert_equal(range:sub(3, 2), '')
+	test.assert_equal(text:iconv('UTF-16LE', 'UTF-8'), buffer:get_text():iconv('UTF-16LE', 'UTF-8'))
+end)
+
+test('buffer.text_view should be writable to files', function()
+	buffer:append_text('text')
+	local f<close> = test.tmpfile()
+
+	local file = io.open(f.filename, 'wb')
+	buffer:text_view():write(file):close()
+
+	test.assert_equal(f:read(), 'text')
+end)
+
+test('buffer.text_view should be invalidated by text changes', function()
+	buffer:append_text('text')
+	local text = buffer:text_view()
+
+	buffer:append_text('more text')
+
+	local access_invalid_view = function() return tostring(text) end
+	test.assert_raises(access_invalid_view, 'text view invalidated')
+end)
+
+test('buffer.batch should call functions and set properties in order', function()
+	buffer:append_text(test.lines{'one', 'two'})
+
+	buffer:batch{
+		'indicator_current', 2, 'indicator_fill_range', 5, 3, --
+		'marker_add', 2, 1, --
+		'line_state', 1, 3, --
+		'insert_text', 1, 'zero ' --
+	}
+
+	test.assert_equal(buffer:get_text(), test.lines{'zero one', 'two'})
+	test.assert_equal(buffer.indicator_current, 2)
+	test.assert_equal(buffer:indicator_ranges(2), {10, 13})
+	test.assert_equal(buffer:marker_get(2), 1 << 0)
+	test.assert_equal(buffer.line_state[1], 3)
+end)
+
+test('buffer.batch should only use the given number of operations', function()
+	buffer:batch({'line_state', 1, 1, 'line_state', 1, 2}, 3)
+
+	test.assert_equal(buffer.line_state[1], 1)
+end)
+
+test('buffer.batch should raise errors for invalid operations', function()
+	local unknown_name = function() buffer:batch{'unknown', 1} end
+	local read_only_property = function() buffer:batch{'length', 1} end
+
+	test.assert_raises(unknown_name, 'unknown Scintilla function or property at index 1')
+	test.assert_raises(read_only_property, 'read-only property at index 1')
+end)
+
+test('buffer function calls should be benchmarked #bench', function()
+	local n, line_from_position = 1000000, buffer.line_from_position
+	local start = os.clock()
+	for _ = 1, n do buffer:line_from_position(1) end
+	local lookup_and_call = os.clock() - start
+	start = os.clock()
+	for _ = 1, n do line_from_position(buffer, 1) end
+	local call = os.clock() - start
+
+	io.output():write(string.format('buffer:method(): %.0f calls/s (%.0f/s without lookup)\n',
+		n / lookup_and_call, n / call))
+end)
+
+test('buffer.batch should be benchmarked #bench', function()
+	local n, ops = 100000, {}
+	buffer:append_text(string.rep('x', n))
+	local start = os.clock()
+	buffer:start_styling(1, 0)
+	for _ = 1, n do buffer:set_styling(1, view.STYLE_DEFAULT) end
+	local calls = os.clock() - start
+	local batch = function()
+		start = os.clock()
+		buffer:start_styling(1, 0)
+		for i = 1, 3 * n, 3 do ops[i], ops[i + 1], ops[i + 2] = 'set_styling', 1, view.STYLE_DEFAULT end
+		buffer:batch(ops, 3 * n)
+		return os.clock() - start
+	end
+	local new_batch, reused_batch = batch(), batch() -- the second one reuses ops
+
+	io.output():write(string.format(
+		'buffer:set_styling(): %.0f calls/s (%.0f/s batched, %.0f/s batched with a reused list)\n',
+		n / calls, n / new_batch, n / reused_batch))
+end)
+
 --- Load buffer and view API from .buffer.luadoc.
 local function load_props()
 	local buffer_props, view_props = {}, {}
@@ -58,6 +296,8 @@ local function file(filename) return ((_HOME .. '/' .. filename):gsub('\\', '/')
 local ignore_ids = {_G = true, M = true, _SCINTILLA = true, snippets = true}
 local ignore_exprs = {['ui.size'] = true}
 local exceptions = {
+	[file('core/events.lua')] = {'events.batch'}, --
+	[file('core/file_io.lua')] = {'loader:close'}, --
 	[file('core/init.lua')] = {'env.view'},
 	[file('core/lexer.lua')] = {'lexer.style_at', 'lexer.fold_level', 'lexer.line_from_position'},
 	[file('core/ui.lua')] = {'view:goto_pos'}, --
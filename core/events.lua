@@ -20,7 +20,7 @@
 -- propagation of an event like a keypress if your event handler handled it, or if you want to
 -- use the event framework to pass values.
 -- @module events
-local M = {}
+local M = events
 
 --- Emitted when macOS tells Textadept to open a file.
 -- Arguments:
@@ -220,6 +220,19 @@ local M = {}
 -- - *mode*: Either "light" or "dark".
 -- @field MODE_CHANGED
 
+--- Emitted after the outermost `events.batch()` call or undo action (`buffer:begin_undo_action()`
+-- and `buffer:end_undo_action()`) ends, if text in the current buffer changed during it.
+-- Switching buffers, or an error in an `events.batch()` function, discards any changes recorded
+-- so far.
+-- Unlike `events.MODIFIED`, which is emitted for every individual change, this event is emitted
+-- once, which is more efficient for handlers that only need to know what ranges of text changed.
+-- Arguments:
+--
+-- - *spans*: List of changes, in the order they happened. Each change is a table with
+--	`position`, `length`, and `modification_type` fields. Contiguous insertions or deletions
+--	are merged into a single change.
+-- @field MODIFIED_BATCH
+
 --- Emitted by the terminal version for an unhandled mouse event.
 -- A handler should return `true` if it handled the event. Otherwise Textadept will try again.
 -- (This side effect for a `false` or `nil` return is useful for sending the original mouse
@@ -364,89 +377,207 @@ local M = {}
 -- Emitted by `view:zoom_in()` and `view:zoom_out()`.
 -- @field ZOOM
 
---- Map of event names to tables of handler functions.
--- Handler tables are auto-created as needed.
--- @table handlers
+--- Map of deferred handlers to lists of arguments for their pending calls.
+-- @table pending
+-- @local
+local pending = {}
+
+--- Map of deferred handlers to whether or not they were emitted again while their calls were
+-- pending, which restarts their delays.
+-- @table restarted
 -- @local
-local handlers = setmetatable({}, {
-	__index = function(t, k)
-		t[k] = {}
-		return t[k]
+local restarted = {}
+
+--- Map of deferred handlers to functions that make their pending calls.
+-- @table callers
+-- @local
+local callers = setmetatable({}, {__mode = 'k'})
+
+--- Connects to event *event* a handler that calls function *f* after a delay instead of right
+-- away, and returns that handler for passing to `events.disconnect()`.
+-- By default, a burst of emissions results in a single call to *f* once *event* has not been
+-- emitted for the delay, with the arguments of the last emission. This is useful for expensive
+-- handlers that do not need to run on every emission, like some `events.UPDATE_UI` handlers.
+-- Since *f* is called later, its return value cannot stop the propagation of *event*.
+-- Disconnecting the handler cancels any pending call.
+-- @param event The string event name.
+-- @param f The Lua function to call after *event* is emitted.
+-- @param[opt] options Optional table of options:
+--
+--	- `delay`: The number of seconds to wait before calling *f*. The default value is `0.1`.
+--	- `coalesce`: Whether or not to collapse a burst of emissions into a single call. If
+--		`false`, *f* is called once per emission. The default value is `true`.
+--	- `filter`: Function that is called right away with an emission's arguments and returns
+--		whether or not that emission should result in a call to *f*. The default value is `nil`,
+--		which does not ignore any emissions.
+-- @return handler connected to *event*
+-- @usage events.connect_deferred(events.UPDATE_UI, update_outline, {delay = 0.5})
+function M.connect_deferred(event, f, options)
+	assert_type(f, 'function', 2)
+	local delay = assert_type(options, 'table/nil', 3) and options.delay or 0.1
+	local coalesce = not options or options.coalesce ~= false
+	local filter = options and options.filter
+	local handler
+	local function call()
+		local calls = pending[handler]
+		pending[handler], restarted[handler] = nil, nil
+		for _, args in ipairs(calls) do f(table.unpack(args, 1, args.n)) end
 	end
-})
+	handler = function(...)
+		if filter and not filter(...) then return end
+		local calls = pending[handler]
+		if not calls then
+			calls = {}
+			pending[handler] = calls
+			-- Use a single timer per burst, and have it wait another delay after more emissions.
+			timeout(delay, function()
+				if pending[handler] ~= calls then return false end -- flushed or disconnected
+				if restarted[handler] then
+					restarted[handler] = nil
+					return true
+				end
+				call()
+			end)
+		elseif coalesce then
+			restarted[handler] = true
+		end
+		calls[coalesce and 1 or #calls + 1] = table.pack(...) -- replaces any earlier coalesced call
+	end
+	callers[handler] = call
+	M.connect(event, handler)
+	return handler
+end
+
+--- Immediately calls the functions of deferred handlers that are waiting for their delay
+-- to pass.
+-- This function is primarily used in Textadept's own unit tests.
+-- @see connect_deferred
+function M.flush_deferred()
+	local calls = {}
+	for handler in pairs(pending) do calls[#calls + 1] = callers[handler] end
+	for _, call in ipairs(calls) do call() end
+end
+
+-- Cancel any pending calls of deferred handlers when disconnecting them.
+local disconnect = M.disconnect
+M.disconnect = function(event, f)
+	pending[f], restarted[f] = nil, nil
+	disconnect(event, f)
+end
+
+-- LuaFormatter off
+local textadept_events = {'appleevent_odoc','buffer_after_replace_text','buffer_after_switch','buffer_before_replace_text','buffer_before_switch','buffer_deleted','buffer_new','csi','command_text_changed','error','find','find_text_changed','focus','initialized','keypress','menu_clicked','mode_changed','modified_batch','mouse','quit','replace','replace_all','reset_after','reset_before','resume','suspend', 'tab_clicked','tab_close_clicked','unfocus','view_after_switch','view_before_switch','view_new'}
+-- LuaFormatter on
+for _, v in pairs(textadept_events) do M[v:upper()] = v end
+
+-- The functions below are Lua C functions.
 
 --- Adds function *f* to the set of event handlers for event *event* at position *index*.
--- If *index* not given, appends *f* to the set of handlers. *event* may be any arbitrary string
--- and does not need to have been previously defined.
+-- If *index* not given, inserts *f* after all handlers whose priority is greater than or equal
+-- to its own. *event* may be any arbitrary string and does not need to have been previously
+-- defined.
 -- @param event The string event name.
 -- @param f The Lua function to connect to *event*.
--- @param[opt] index Optional index to insert the handler into.
+-- @param[opt] index Optional index to insert the handler into, or a table of options:
+--
+--	- `priority`: The priority of the handler. Handlers with higher priorities are called
+--		first, and handlers with equal priorities are called in the order they were connected.
+--		The default value is `0`.
 -- @usage events.connect('my_event', function() ... end)
-function M.connect(event, f, index)
-	assert_type(event, 'string', 1)
-	assert_type(f, 'function', 2)
-	assert_type(index, 'number/nil', 3)
-	M.disconnect(event, f) -- in case it already exists
-	table.insert(handlers[event], index or #handlers[event] + 1, f)
-end
+-- @usage events.connect('my_event', function() ... end, {priority = 10})
+-- @function connect
 
 --- Removes function *f* from the set of handlers for event *event*.
 -- @param event The string event name.
 -- @param f The Lua function connected to *event*.
-function M.disconnect(event, f)
-	assert_type(f, 'function', 2)
-	for i = 1, #handlers[assert_type(event, 'string', 1)] do
-		if handlers[event][i] == f then
-			table.remove(handlers[event], i)
-			break
-		end
-	end
-end
+-- @function disconnect
+
+--- Returns a list of the handlers connected to event *event*, in the order they are called,
+-- along with a list of their priorities.
+-- @param event The string event name.
+-- @return list of handlers
+-- @return list of priorities
+-- @usage local handlers, priorities = events.handlers(events.MODIFIED)
+-- @function handlers
 
-local error_emitted = false
 --- Sequentially calls all handler functions for event *event* with the given arguments.
 -- *event* may be any arbitrary string and does not need to have been previously defined. If
 -- any handler explicitly returns a value that is not `nil`, `emit()` returns that value and
 -- ceases to call subsequent handlers. This is useful for stopping the propagation of an event
 -- like a keypress after it has been handled, or for passing back values from handlers.
+-- If a handler raises an error, `emit()` emits `events.ERROR` with that error, returns it, and
+-- ceases to call subsequent handlers.
 -- @param event The string event name.
 -- @param[opt] ... Arguments passed to the handler.
 -- @return `nil` unless any any handler explicitly returned a non-`nil` value; otherwise returns
 --	that value
 -- @usage events.emit('my_event', 'my message')
-function M.emit(event, ...)
-	local event_handlers = handlers[assert_type(event, 'string', 1)]
-	local i = 1
-	while i <= #event_handlers do
-		local handler = event_handlers[i]
-		local ok, result = pcall(handler, ...)
-		if not ok then
-			if not error_emitted then
-				error_emitted = true
-				M.emit(M.ERROR, result)
-				error_emitted = false
-			else
-				io.stderr:write(result) -- prevent infinite loop
-			end
-		end
-		if result ~= nil then return result end
-		if event_handlers[i] == handler then i = i + 1 end -- unless M.disconnect()
-	end
-end
-
--- Handles Scintilla notifications.
-M.connect('SCN', function(notification)
-	local iface = _SCINTILLA[notification.code]
-	local args = {}
-	for i = 2, #iface do args[i - 1] = notification[iface[i]] end
-	return M.emit(iface[1], table.unpack(args))
-end)
-
--- Set event constants (events are numeric ID keys).
-for k, v in pairs(_SCINTILLA) do if type(k) == 'number' then M[v[1]:upper()] = v[1] end end
--- LuaFormatter off
-local textadept_events = {'appleevent_odoc','buffer_after_replace_text','buffer_after_switch','buffer_before_replace_text','buffer_before_switch','buffer_deleted','buffer_new','csi','command_text_changed','error','find','find_text_changed','focus','initialized','keypress','menu_clicked','mode_changed','mouse','quit','replace','replace_all','reset_after','reset_before','resume','suspend', 'tab_clicked','tab_close_clicked','unfocus','view_after_switch','view_before_switch','view_new'}
--- LuaFormatter on
-for _, v in pairs(textadept_events) do M[v:upper()] = v end
+-- @function emit
+
+--- Calls function *f* while batching buffer modifications, and returns its results.
+-- When the outermost batch ends, emits `events.MODIFIED_BATCH` with the changes made during it.
+-- `events.MODIFIED` is still emitted for each individual change.
+-- @param f The function to call.
+-- @return *f*'s results
+-- @usage events.batch(function() buffer:replace_target('text') end)
+-- @function batch
+
+--- Starts or stops recording statistics for calls to event handlers.
+-- Profiling is disabled by default, and has a negligible cost while disabled.
+-- Stopping profiling does not reset statistics.
+-- The `--profile-events` command line option enables profiling and writes these statistics to
+-- a file when Textadept quits.
+-- @param[opt] enable Whether or not to record statistics. The default value is `true`.
+-- @see reset_stats
+-- @function profile
+
+--- Returns a list of call statistics for each event handler that has been called while
+-- profiling, ordered by cumulative time from most to least.
+-- Each statistic is a table with the following fields:
+--
+-- - `event`: The name of the event the handler is connected to.
+-- - `handler`: The handler's source file and line number, in "source:line" form.
+-- - `calls`: The number of calls made.
+-- - `time`: The cumulative time spent in those calls, in seconds.
+-- - `max_time`: The time spent in the longest call, in seconds.
+-- - `bytes`: The approximate cumulative number of bytes allocated by those calls.
+-- @return list of call statistics
+-- @usage for _, stat in ipairs(events.stats()) do print(stat.handler, stat.time) end
+-- @function stats
+
+--- Clears all recorded event handler statistics.
+-- @function reset_stats
+
+--- Starts recording events emitted by Textadept to trace file *filename*, or stops recording
+-- if *filename* is `nil`.
+-- Each event is recorded with its arguments and the time it was emitted, so that the trace
+-- can be replayed later with `events.replay()` as a benchmark. Only events emitted by Textadept
+-- itself (e.g. keypresses, mouse clicks, and Scintilla notifications) are recorded, not events
+-- emitted from Lua. Events emitted while handling a recorded event are not recorded either,
+-- since replaying that event emits them again. Events replayed while recording are recorded.
+-- Arguments that are not booleans, numbers, or strings are recorded as `nil`.
+-- The `--record` command line option starts recording to the given file.
+-- @param[opt] filename The filename to record to.
+-- @return `true` if recording started, or `nil` and an error message on failure
+-- @function record
+
+--- Emits all events recorded in trace file *filename* as fast as possible, and returns a map
+-- of event names to statistics about how long handling them took.
+-- As when typing, keypresses that no handler handles are passed on to Scintilla, and keystroke
+-- latencies are sampled for `ui.latency_stats()` until Scintilla actually paints (recorded
+-- `events.PAINTED` events do not count). Recorded Scintilla notifications that such
+-- a keypress makes Scintilla emit again are skipped. The `events.INITIALIZED` and
+-- `events.QUIT` events are not replayed.
+-- Each statistic is a table with the following fields:
+--
+-- - `count`: The number of times the event was emitted.
+-- - `p50`, `p90`, `p99`: The 50th, 90th, and 99th percentile times spent handling the event,
+--	in seconds.
+-- - `max`: The longest time spent handling the event, in seconds.
+--
+-- The `--replay` command line option replays the given file, prints these statistics, and quits.
+-- @param filename The filename of a trace recorded by `events.record()`.
+-- @return map of event statistics, or `nil` and an error message if the file could not be read
+-- @function replay
 
 return M
@@ -22,6 +22,56 @@ test('events.emit should not call a disconnected handler', function()
 	test.assert_equal(handler.called, false)
 end)
 
+test('events.emit should not call anything for an event without handlers', function()
+	local handler = test.stub()
+	events.connect(event, handler)
+	events.disconnect(event, handler)
+	local lua_calls = 0
+	local count_lua_calls = function()
+		if debug.getinfo(2, 'S').what == 'Lua' then lua_calls = lua_calls + 1 end
+	end
+
+	debug.sethook(count_lua_calls, 'c')
+	local result = events.emit(event)
+	debug.sethook()
+
+	test.assert_equal(result, nil)
+	test.assert_equal(lua_calls, 0)
+end)
+
+test('events.handlers should return connected handlers and their priorities in order', function()
+	local f1, f2 = function() end, function() end
+	local _<close> = test.connect(event, f1)
+	local _<close> = test.connect(event, f2, {priority = 10})
+
+	local handlers, priorities = events.handlers(event)
+
+	test.assert_equal(handlers, {f2, f1})
+	test.assert_equal(priorities, {10, 0})
+end)
+
+test('events.connect and events.disconnect should update the modification event mask', function()
+	-- Temporarily disconnect all existing events.MODIFIED handlers, and restore them afterwards
+	-- in the same order with the same priorities.
+	local handlers, priorities = events.handlers(events.MODIFIED)
+	for _, f in ipairs(handlers) do events.disconnect(events.MODIFIED, f) end
+	local _<close> = test.defer(function()
+		for i, f in ipairs(handlers) do
+			events.connect(events.MODIFIED, f, {priority = priorities[i]})
+		end
+	end)
+	local disconnected_mask = view.mod_event_mask
+	local handler = function() end
+
+	events.connect(events.MODIFIED, handler)
+	local connected_mask = view.mod_event_mask
+	events.disconnect(events.MODIFIED, handler)
+
+	test.assert_equal(disconnected_mask, view.MOD_INSERTTEXT | view.MOD_DELETETEXT)
+	test.assert_equal(connected_mask, view.MODEVENTMASKALL)
+	test.assert_equal(view.mod_event_mask, view.MOD_INSERTTEXT | view.MOD_DELETETEXT)
+end)
+
 test('events.connect should only connect a handler once', function()
 	local handler = test.stub()
 
@@ -45,6 +95,37 @@ test('events.connect should allow for inserting a handler before another', funct
 	test.assert_equal(call_order, {'f2', 'f1'})
 end)
 
+test('events.connect should raise an error for an invalid index', function()
+	local connect_out_of_bounds = function() events.connect(event, function() end, 2) end
+	local connect_at_zero = function() events.connect(event, function() end, 0) end
+
+	test.assert_raises(connect_out_of_bounds, 'position out of bounds')
+	test.assert_raises(connect_at_zero, 'position out of bounds')
+end)
+
+test('events.connect should call handlers in priority order', function()
+	local call_order = {}
+	local record = function(name) call_order[#call_order + 1] = name end
+	local low = function() record('low') end
+	local default = function() record('default') end
+	local high1 = function() record('high1') end
+	local high2 = function() record('high2') end
+
+	local _<close> = test.connect(event, low, {priority = -1})
+	local _<close> = test.connect(event, default)
+	local _<close> = test.connect(event, high1, {priority = 10})
+	local _<close> = test.connect(event, high2, {priority = 10}) -- should run after high1
+	events.emit(event)
+
+	test.assert_equal(call_order, {'high1', 'high2', 'default', 'low'})
+end)
+
+test('events.connect should raise an error for an invalid priority', function()
+	local connect_invalid = function() events.connect(event, function() end, {priority = 'high'}) end
+
+	test.assert_raises(connect_invalid, 'priority must be an integer')
+end)
+
 test('events.emit should stop calling handlers when one returns a value', function()
 	local returns_value = test.stub(true)
 	local should_ignore = test.stub()
@@ -80,6 +161,21 @@ test('events.emit should not skip calling handlers if one removes itself', funct
 	test.assert_equal(should_not_skip.called, true)
 end)
 
+test('events.emit should not call handlers inserted before the current one', function()
+	local inserted = test.stub()
+	local inserts = test.stub(function() events.connect(event, inserted, 1) end)
+	local should_not_skip = test.stub()
+	local _<close> = test.connect(event, inserts)
+	local _<close> = test.connect(event, should_not_skip)
+	local _<close> = test.defer(function() events.disconnect(event, inserted) end)
+
+	events.emit(event)
+
+	test.assert_equal(inserts.called, true) -- would be 2 if called again
+	test.assert_equal(inserted.called, false)
+	test.assert_equal(should_not_skip.called, true)
+end)
+
 test('events.emit should emit an event if a handler errors', function()
 	local error_handler = test.stub(false) -- halt propagation to default error handler
 	local _<close> = test.connect(events.ERROR, error_handler, 1)
@@ -107,3 +203,253 @@ test('events.emit should write to io.stderr if the default error handler itself
 	local stderr = stderr_writer.args[2]
 	test.assert_contains(stderr, error_message)
 end)
+
+test('Scintilla notifications should be emitted as events with positional arguments', function()
+	local args
+	local _<close> = test.connect(events.MODIFIED, function(...)
+		local modification_type = select(2, ...)
+		if modification_type & buffer.MOD_INSERTTEXT > 0 then args = {...} end
+	end)
+
+	buffer:append_text('text')
+
+	test.assert(args, 'should have emitted an insertion event')
+	local position, _, text, length = table.unpack(args)
+	test.assert_equal(position, 1)
+	test.assert_equal(text, 'text')
+	test.assert_equal(length, 4)
+end)
+
+test('events.batch should emit events.MODIFIED_BATCH once with merged changes', function()
+	local modified_batch = test.stub()
+	local _<close> = test.connect(events.MODIFIED_BATCH, modified_batch)
+
+	events.batch(function()
+		buffer:append_text('a')
+		buffer:append_text('b')
+	end)
+
+	test.assert_equal(modified_batch.called, true)
+	local spans = modified_batch.args[1]
+	test.assert_equal(#spans, 1)
+	test.assert_equal(spans[1].position, 1)
+	test.assert_equal(spans[1].length, 2)
+	test.assert(spans[1].modification_type & buffer.MOD_INSERTTEXT > 0, 'should have inserted')
+end)
+
+test('buffer:end_undo_action should emit events.MODIFIED_BATCH', function()
+	buffer:append_text('text')
+	local modified_batch = test.stub()
+	local _<close> = test.connect(events.MODIFIED_BATCH, modified_batch)
+
+	buffer:begin_undo_action()
+	buffer:delete_range(1, 1)
+	buffer:append_text('!')
+	buffer:end_undo_action()
+
+	test.assert_equal(modified_batch.called, true)
+	test.assert_equal(#modified_batch.args[1], 2)
+end)
+
+test('events.batch should discard changes and stop batching if its function errors', function()
+	local modified_batch = test.stub()
+	local _<close> = test.connect(events.MODIFIED_BATCH, modified_batch)
+
+	pcall(events.batch, function()
+		buffer:begin_undo_action()
+		buffer:append_text('a')
+		error('error')
+	end)
+	local discarded = modified_batch.called
+	events.batch(function() buffer:append_text('b') end)
+
+	test.assert_equal(discarded, false)
+	test.assert_equal(modified_batch.called, true)
+	test.assert_equal(modified_batch.args[1][1].position, 2)
+end)
+
+test('unbalanced undo actions should only affect batching in their own buffer', function()
+	local buffer1 = buffer
+	buffer.new()
+	local modified_batch = test.stub()
+	local _<close> = test.connect(events.MODIFIED_BATCH, modified_batch)
+
+	buffer1:begin_undo_action() -- never ended
+	buffer1:append_text('a')
+	events.batch(function() buffer:append_text('b') end)
+
+	test.assert_equal(modified_batch.called, true)
+	test.assert_equal(#modified_batch.args[1], 1)
+	test.assert_equal(modified_batch.args[1][1].position, 1)
+end)
+
+test('switching buffers should stop batching changes in the previous buffer', function()
+	local buffer1 = buffer
+	local modified_batch = test.stub()
+	local _<close> = test.connect(events.MODIFIED_BATCH, modified_batch)
+
+	buffer:begin_undo_action() -- never ended
+	buffer:append_text('a')
+	buffer.new()
+	view:goto_buffer(buffer1)
+	buffer:begin_undo_action()
+	buffer:append_text('b')
+	buffer:end_undo_action()
+
+	test.assert_equal(modified_batch.called, true)
+	test.assert_equal(#modified_batch.args[1], 1)
+	test.assert_equal(modified_batch.args[1][1].position, 2)
+end)
+
+test('events.stats should record calls to event handlers while profiling', function()
+	local handler = function() end
+	local _<close> = test.connect(event, handler)
+	events.reset_stats()
+	events.profile(true)
+	local _<close> = test.defer(function() events.profile(false) end)
+
+	events.emit(event)
+	events.emit(event)
+
+	local stats = events.stats()
+	test.assert_equal(#stats, 1)
+	test.assert_equal(stats[1].event, event)
+	test.assert_contains(stats[1].handler, 'events_test.lua:')
+	test.assert_equal(stats[1].calls, 2)
+	test.assert(stats[1].time >= stats[1].max_time, 'max time should not exceed total time')
+end)
+
+test('events.connect_deferred should collapse a burst of emissions into one call', function()
+	local deferred = test.stub()
+	local handler = events.connect_deferred(event, deferred)
+	local _<close> = test.defer(function() events.disconnect(event, handler) end)
+
+	events.emit(event, 1)
+	events.emit(event, 2)
+	local called_immediately = deferred.called
+	events.flush_deferred()
+
+	test.assert_equal(called_immediately, false)
+	test.assert_equal(deferred.called, true)
+	test.assert_equal(deferred.args, {2})
+end)
+
+test('events.connect_deferred should call once per emission if not coalescing', function()
+	local args = {}
+	local deferred = function(arg) args[#args + 1] = arg end
+	local handler = events.connect_deferred(event, deferred, {coalesce = false})
+	local _<close> = test.defer(function() events.disconnect(event, handler) end)
+
+	events.emit(event, 1)
+	events.emit(event, 2)
+	events.flush_deferred()
+
+	test.assert_equal(args, {1, 2})
+end)
+
+test('events.connect_deferred should ignore emissions its filter rejects', function()
+	local deferred = test.stub()
+	local handler = events.connect_deferred(event, deferred,
+		{filter = function(arg) return arg > 1 end})
+	local _<close> = test.defer(function() events.disconnect(event, handler) end)
+
+	events.emit(event, 2)
+	events.emit(event, 1)
+	events.flush_deferred()
+
+	test.assert_equal(deferred.called, true)
+	test.assert_equal(deferred.args, {2})
+end)
+
+test('events.disconnect should cancel a pending deferred call', function()
+	local deferred = test.stub()
+	local handler = events.connect_deferred(event, deferred)
+
+	events.emit(event)
+	events.disconnect(event, handler)
+	events.flush_deferred()
+
+	test.assert_equal(deferred.called, false)
+end)
+
+test('events.replay should emit events recorded by events.record', function()
+	local trace<close> = test.tmpfile('.bin')
+	events.record(trace.filename)
+	buffer:append_text('text') -- emits events.MODIFIED, among others
+	events.record(nil)
+	local modified = test.stub()
+	local _<close> = test.connect(events.MODIFIED, modified)
+
+	local stats = events.replay(trace.filename)
+
+	test.assert(modified.called, 'should have emitted events.MODIFIED')
+	test.assert(stats[events.MODIFIED].count > 0, 'should have recorded events.MODIFIED')
+	test.assert(stats[events.MODIFIED].max >= stats[events.MODIFIED].p50, 'max should be largest')
+end)
+
+test('events.replay should pass unhandled keys to Scintilla', function()
+	local f<close> = test.tmpfile('.bin', test.trace{events.KEY, string.byte(QT and 'A' or 'a'), 0})
+
+	events.replay(f.filename)
+
+	test.assert_equal(buffer:get_text(), 'a')
+end)
+
+test('events.replay should reproduce the text typed while recording', function()
+	local typing<close> = test.tmpfile('.bin', test.trace{events.KEY, string.byte('('), 0})
+	local trace<close> = test.tmpfile('.bin')
+	events.record(trace.filename)
+	events.replay(typing.filename) -- types '(', which is auto-paired
+	events.record(nil)
+	local recorded_text = buffer:get_text()
+	buffer:clear_all()
+
+	events.replay(trace.filename)
+
+	test.assert_equal(recorded_text, '()')
+	test.assert_equal(buffer:get_text(), recorded_text)
+end)
+
+test('events.replay should replay records with many values', function()
+	local values = {event}
+	for i = 2, 255 do values[i] = i end
+	local f<close> = test.tmpfile('.bin', test.trace(values))
+	local handler = test.stub()
+	local _<close> = test.connect(event, handler)
+
+	events.replay(f.filename)
+
+	test.assert_equal(#handler.args, 254)
+end)
+
+test('events.replay should stop at strings longer than the trace', function()
+	local f<close> = test.tmpfile('.bin', 'TATRACE1' .. string.pack('=dBBI4', 0, 1, 4, 0xFFFFFFFF))
+
+	local stats = events.replay(f.filename)
+
+	test.assert_equal(stats, {})
+end)
+
+test('events.replay should not replay events.INITIALIZED or events.QUIT', function()
+	local f<close> = test.tmpfile('.bin', test.trace({events.INITIALIZED}, {events.QUIT}))
+	local initialized = test.stub()
+	local _<close> = test.connect(events.INITIALIZED, initialized)
+	local quit = test.stub(true) -- prevent quitting
+	local _<close> = test.connect(events.QUIT, quit, 1)
+
+	events.replay(f.filename)
+
+	test.assert_equal(initialized.called, false)
+	test.assert_equal(quit.called, false)
+end)
+
+test('events.replay should replay numbers as integers or floats', function()
+	local f<close> = test.tmpfile('.bin', test.trace{event, 1, 1.5})
+	local handler = test.stub()
+	local _<close> = test.connect(event, handler)
+
+	events.replay(f.filename)
+
+	test.assert_equal(math.type(handler.args[1]), 'integer')
+	test.assert_equal(handler.args[2], 1.5)
+end)
@@ -48,15 +48,28 @@ io.detect_indentation = true
 -- The default value is `false` on Windows, and `true` on macOS, Linux, and BSD.
 io.ensure_final_newline = not WIN32
 
+--- Whether or not to wait for saved files to be physically written to disk.
+-- This makes saved files safer from power loss or system crashes, but saving is slower.
+-- The default value is `false`.
+io.sync_on_save = false
+
 --- The maximum number of files listed in the quick open dialog.
 -- The default value is `5000`.
 io.quick_open_max = 5000
 
+--- The size in bytes at which files are opened in large file mode.
+-- The default value is `67108864` (64MB).
+-- @see buffer.large_file
+io.large_file_size = 64 * 1024 * 1024
+
 --- List of recently opened files, the most recent being towards the top.
 io.recent_files = {}
 
 --- List of encodings to attempt to decode files as.
 -- The default list contains UTF-8, ASCII, CP1252, and UTF-16.
+-- Files with a byte order mark, valid UTF-8 files, and UTF-16 files without a byte order mark
+-- are detected by `io.detect_encoding()` regardless of this list. Other files are decoded with
+-- the first encoding in this list that succeeds.
 --
 -- You should add to this list if you get a "Conversion failed" error when trying to open a file
 -- whose encoding is not recognized. Valid encodings are [GNU iconv's encodings][] and include:
@@ -76,11 +89,151 @@ io.recent_files = {}
 
 io.encodings = {'UTF-8', 'ASCII', 'CP1252', 'UTF-16'}
 
+--- Sets up buffer *buffer* for editing file *filename* after loading it with encoding *encoding*,
+-- and emits `events.FILE_OPENED`.
+local function set_up(buffer, filename, encoding)
+	buffer.encoding, buffer.code_page = encoding, encoding and buffer.CP_UTF8 or 0
+	-- Detect indentation and EOL mode from the start of the file.
+	local text = buffer:text_range(1, math.min(buffer.length, 65535) + 1)
+	-- Detect indentation.
+	if io.detect_indentation then
+		if text:find('\n\t+%S') then
+			buffer.use_tabs = true
+		else
+			local s, e = text:find('\n()   ? ? ? ? ? ?()%S')
+			if s and e then buffer.use_tabs, buffer.tab_width = false, e - 1 - s end
+		end
+	end
+	-- Detect EOL mode.
+	local s, e = text:find('\r?\n')
+	if s then buffer.eol_mode = buffer[s ~= e and 'EOL_CRLF' or 'EOL_LF'] end
+	-- Set buffer properties.
+	if buffer == _G.buffer then view.first_visible_line, view.x_offset = 1, 0 end -- reset scroll
+	buffer:empty_undo_buffer()
+	buffer.mod_time = lfs.attributes(filename, 'modification') or os.time()
+	buffer.filename = filename
+	buffer:set_save_point()
+	buffer:set_lexer(buffer.large_file and 'text' or nil) -- auto-detect unless large
+	events.emit(events.FILE_OPENED, filename)
+end
+
+--- Returns the list of encodings to try loading a file with, given its encoding *detected*
+-- by `io.detect_encoding()` and whether or not the start of that file has NUL bytes.
+-- If UTF-8 was only *guessed* from the start of the file, the list falls back on the rest of
+-- `io.encodings` in case the file turns out not to be UTF-8.
+local function get_encodings(detected, has_zeroes, guessed)
+	local encodings = {detected}
+	if detected and not (guessed and detected == 'UTF-8') then return encodings end
+	for _, enc in ipairs(io.encodings) do
+		-- The file is not UTF-8, and non-UTF encodings cannot handle \0.
+		if enc ~= 'UTF-8' and (not has_zeroes or enc:find('^UTF')) then
+			encodings[#encodings + 1] = enc
+		end
+	end
+	return encodings
+end
+
+--- Map of buffers being loaded by `load_async()`.
+-- @table loading
+-- @local
+local loading = setmetatable({}, {__mode = 'k'})
+
+--- The number of seconds `load_async()` spends loading per timeout tick.
+local LOAD_BUDGET = 0.05
+
+--- The number of bytes at the start of a large file to validate as UTF-8.
+-- The rest of the file is assumed to be valid UTF-8 too, and is loaded as-is.
+local LARGE_FILE_VALIDATE_SIZE = 65536
+
+--- Loads file *filename* into buffer *buffer* incrementally on the main thread in between
+-- processing UI events, and then sets up that buffer for editing.
+-- Each step loads chunks for up to `LOAD_BUDGET` seconds of wall-clock time. The first step
+-- detects the file's encoding from its start, and loading tries each candidate encoding in turn
+-- (validating UTF-8 as it goes, unless the buffer is in large file mode) before treating the
+-- file as binary. If the file turns out not to be UTF-8 after all, the text loaded so far is
+-- converted from the next candidate encoding and loading continues from there rather than
+-- starting over.
+-- The buffer is read-only and cannot be saved while loading, and the statusbar shows loading
+-- progress.
+local function load_async(buffer, filename)
+	local name = filename:match('[^/\\]+$'):iconv('UTF-8', _CHARSET)
+	local encodings, i, loader = nil, 0, nil
+	buffer.filename, buffer.read_only, loading[buffer] = filename, true, true
+	local function stop()
+		if loader then loader:close() end
+		buffer.read_only, loading[buffer] = false, nil
+		ui.statusbar_text = ''
+	end
+	-- Loads the next few chunks and returns whether or not there is more to load.
+	local function step()
+		if not encodings then
+			local detected, has_zeroes = io.detect_encoding(filename, LARGE_FILE_VALIDATE_SIZE)
+			encodings = get_encodings(detected, has_zeroes, true)
+		end
+		if not loader then
+			i = i + 1
+			local encoding = encodings[i]
+			if buffer.large_file and encoding == 'UTF-8' then encoding = nil end -- as-is
+			loader = assert(io.loader(buffer, filename, encoding))
+		end
+		local ok, done, progress = pcall(loader.load, loader, nil, LOAD_BUDGET)
+		if not ok then
+			-- Continue a file that turned out not to be UTF-8 in the next encoding from where
+			-- validation failed. An encoding that cannot convert the text so far is skipped.
+			if encodings[i] == 'UTF-8' and encodings[i + 1] then
+				i = i + 1
+				if pcall(loader.reencode, loader, encodings[i]) then return true end
+			end
+			loader:close()
+			loader = nil
+			return true -- try the next encoding
+		end
+		if done == nil then error(progress) end -- read error
+		if not done then
+			ui.statusbar_text = string.format('%s %d%%', name, progress * 100)
+			return true
+		end
+		stop()
+		set_up(buffer, filename, encodings[i])
+	end
+	timeout(0.01, function()
+		if not _BUFFERS[buffer] then -- closed while loading
+			if loader then loader:close() end
+			return false
+		end
+		local ok, more = pcall(step)
+		if ok then return more end
+		stop() -- do not leave the buffer read-only and unable to be saved
+		error(more, 0)
+	end)
+end
+
+--- Switches the current view to the current large file buffer's line wrap mode (initially
+-- none), remembering the view's own wrap mode for when it switches to another buffer.
+local function show_large_file()
+	if not buffer.large_file then return end
+	view._wrap_mode, view.wrap_mode = view.wrap_mode, buffer._wrap_mode or view.WRAP_NONE
+end
+events.connect(events.BUFFER_AFTER_SWITCH, show_large_file)
+
+-- Remembers the current large file buffer's line wrap mode and restores the view's own.
+events.connect(events.BUFFER_BEFORE_SWITCH, function()
+	if not buffer.large_file or not view._wrap_mode then return end
+	buffer._wrap_mode, view.wrap_mode, view._wrap_mode = view.wrap_mode, view._wrap_mode, nil
+end)
+
 --- Opens *filenames*, a string filename or list of filenames, or the user-selected filename(s).
 -- Emits `events.FILE_OPENED`.
 -- @param[opt] filenames Optional string filename or table of filenames to open. If `nil`,
 --	the user is prompted with a fileselect dialog.
-function io.open_file(filenames)
+-- @param[opt=false] async Whether or not to load existing files in between processing UI
+--	events so that other buffers can still be edited. Files are loaded incrementally on the
+--	main thread, not on a separate thread. Each file's buffer is read-only and cannot be saved,
+--	and `events.FILE_OPENED` is not emitted until that file has finished loading.
+-- @param[opt] large Whether or not to open files in large file mode. If `nil`, files whose
+--	sizes are at least `io.large_file_size` are opened in large file mode.
+-- @see buffer.large_file
+function io.open_file(filenames, async, large)
 	if not assert_type(filenames, 'string/table/nil', 1) then
 		filenames = ui.dialogs.open{
 			title = _L['Open File'], multiple = true,
@@ -98,47 +251,44 @@ function io.open_file(filenames)
 			end
 		end
 
-		local text = ''
-		if lfs.attributes(filename) then
+		local exists = lfs.attributes(filename)
+		if exists then
 			local f<close>, errmsg = io.open(filename, 'rb')
 			if not f then error(string.format('cannot open %s', errmsg), 2) end
-			text = f:read('a')
-			if not text then goto continue end -- filename exists, but cannot read it
+			local ok, read_errmsg = f:read(0)
+			if not ok and read_errmsg then goto continue end -- filename exists, but cannot read it
 		end
-		local buffer = buffer.new()
-		-- Try to detect character encoding and convert to UTF-8.
-		-- A nil encoding means the file is treated as a binary file.
-		local encoding, has_zeroes = nil, text:sub(1, 65535):find('\0')
-		for _, enc in ipairs(io.encodings) do
-			if has_zeroes and not enc:find('^UTF') then goto continue end -- non-UTF cannot handle \0
-			local ok, conv = pcall(string.iconv, text, 'UTF-8', enc)
-			if not ok then goto continue end
-			encoding, text = enc, conv
-			break
-			::continue::
+		local large_file = large
+		if large_file == nil then
+			large_file = exists and lfs.attributes(filename, 'size') >= io.large_file_size
+		end
+		local buffer = buffer.new(large_file)
+		if large_file then
+			buffer.large_file = true
+			show_large_file()
 		end
-		buffer.encoding, buffer.code_page = encoding, encoding and buffer.CP_UTF8 or 0
-		-- Detect indentation.
-		if io.detect_indentation then
-			if text:find('\n\t+%S') then
-				buffer.use_tabs = true
-			else
-				local s, e = text:find('\n()   ? ? ? ? ? ?()%S')
-				if s and e then buffer.use_tabs, buffer.tab_width = false, e - 1 - s end
+		-- Detect character encoding, falling back on trying each of `io.encodings` in turn,
+		-- and load the file, converting it to UTF-8 if necessary. Only the start of large files
+		-- is validated as UTF-8.
+		-- A nil encoding means the file is treated as a binary file.
+		if not exists then
+			set_up(buffer, filename, io.encodings[1])
+		elseif async then
+			load_async(buffer, filename) -- detects encoding too
+		else
+			local size = large_file and LARGE_FILE_VALIDATE_SIZE or nil
+			local detected, has_zeroes = io.detect_encoding(filename, size)
+			local encodings = get_encodings(detected, has_zeroes, large_file)
+			local encoding
+			for _, enc in ipairs(encodings) do
+				if pcall(io.load_into, buffer, filename, enc ~= 'UTF-8' and enc or nil) then
+					encoding = enc
+					break
+				end
 			end
+			if not encoding then assert(io.load_into(buffer, filename)) end
+			set_up(buffer, filename, encoding)
 		end
-		-- Detect EOL mode.
-		local s, e = text:find('\r?\n')
-		if s then buffer.eol_mode = buffer[s ~= e and 'EOL_CRLF' or 'EOL_LF'] end
-		-- Insert buffer text and set properties.
-		buffer:append_text(text)
-		view.first_visible_line, view.x_offset = 1, 0 -- reset view scroll
-		buffer:empty_undo_buffer()
-		buffer.mod_time = lfs.attributes(filename, 'modification') or os.time()
-		buffer.filename = filename
-		buffer:set_save_point()
-		buffer:set_lexer() -- auto-detect
-		events.emit(events.FILE_OPENED, filename)
 
 		-- Add file to recent files list, eliminating duplicates.
 		table.insert(io.recent_files, 1, filename)
@@ -192,14 +342,17 @@ end
 -- LuaDoc is in core/.buffer.luadoc.
 local function save(buffer)
 	if not buffer then buffer = _G.buffer end
+	if loading[buffer] then -- saving now would overwrite the file with partial text
+		ui.statusbar_text = _L['File is still loading']
+		return nil
+	end
 	if not buffer.filename then return buffer:save_as() end
 	events.emit(events.FILE_BEFORE_SAVE, buffer.filename)
 	if io.ensure_final_newline and buffer.encoding and buffer.char_at[buffer.length] ~= 10 then
 		buffer:append_text(buffer.eol_mode == buffer.EOL_LF and '\n' or '\r\n')
 	end
-	local text = buffer:get_text()
-	if buffer.encoding then text = text:iconv(buffer.encoding, 'UTF-8') end
-	assert(io.open(buffer.filename, 'wb')):write(text):close()
+	-- Conversion errors are raised before the file is replaced or truncated.
+	assert(buffer:save_to(buffer.filename, buffer.encoding, io.sync_on_save))
 	buffer:set_save_point()
 	if buffer ~= _G.buffer then events.emit(events.SAVE_POINT_REACHED, buffer) end -- update tab label
 	buffer.mod_time = lfs.attributes(buffer.filename, 'modification')
@@ -438,3 +591,51 @@ args.register('-', '-', 0, function()
 	buffer:set_save_point()
 	return true -- this counts as a "file"
 end, 'Read stdin into a new buffer')
+
+-- The functions below are Lua C functions.
+
+--- Replaces the text of buffer *buffer* with the contents of file *filename*, converting it
+-- from encoding *encoding* to UTF-8.
+-- The file is read and converted in chunks, so only the buffer and a chunk of the file are in
+-- memory at once. The buffer's undo history is cleared, and its read-only state is ignored.
+-- @param buffer The buffer to load the file into.
+-- @param filename The filename of the file to load.
+-- @param[opt] encoding Optional encoding of the file. If `nil`, the file is loaded as-is.
+-- @return `true`, or `nil` and an error message if the file could not be read
+-- @usage io.load_into(buffer, filename, 'CP1252')
+-- @function load_into
+
+--- Returns a loader that replaces the text of buffer *buffer* with the contents of file
+-- *filename* a chunk at a time, converting it from encoding *encoding* to UTF-8.
+-- The buffer's text is cleared immediately. The loader has a `load(n, seconds)` method that
+-- loads the next *n* chunks (all remaining chunks by default), stopping early once *seconds*
+-- seconds of wall-clock time have passed, and returns whether or not loading finished along
+-- with the fraction of the file loaded so far. It raises an error if conversion fails. If
+-- validating UTF-8 fails, the loader's `reencode(encoding)` method converts the text loaded
+-- so far from *encoding* to UTF-8 in memory, and the loader then continues converting the
+-- rest of the file from *encoding* instead of reading the file again. The `close()` method
+-- stops loading.
+-- Like `io.load_into()`, the buffer's undo history is cleared once loading finishes, and its
+-- read-only state is ignored.
+-- @param buffer The buffer to load the file into.
+-- @param filename The filename of the file to load.
+-- @param[opt] encoding Optional encoding of the file. If `nil`, the file is loaded as-is. If
+--	"UTF-8", the file is validated as it is loaded rather than converted.
+-- @return loader, or `nil` and an error message if the file could not be opened
+-- @usage local loader = io.loader(buffer, filename, 'UTF-8')
+-- @usage while not loader:load(1) do ui.update() end
+-- @function loader
+
+--- Returns the detected character encoding of file *filename* without converting it, along
+-- with whether or not the start of the file contains NUL bytes.
+-- Detects byte order marks, UTF-16 without a byte order mark (based on the positions of NUL
+-- bytes in the start of the file), and valid UTF-8 (by reading the whole file a chunk at
+-- a time, or only its start). Raises an error if the file cannot be read.
+-- @param filename The filename of the file to examine.
+-- @param[opt] size Optional number of bytes to validate as UTF-8 before assuming the rest of
+--	the file is valid too. Validation stops at the end of the chunk that reaches *size*. The
+--	default value validates the whole file.
+-- @return "UTF-8", "UTF-16", "UTF-16LE", "UTF-16BE", or `nil` if the encoding is unknown
+-- @return whether or not the start of the file contains NUL bytes
+-- @usage local encoding = io.detect_encoding(filename) or 'CP1252'
+-- @function detect_encoding
@@ -20,6 +20,39 @@ test("io.open_file should auto-detect and set the file's lexer", function()
 	test.assert_equal(buffer.lexer_language, 'lua')
 end)
 
+test('io.open_file should open files of at least io.large_file_size in large file mode', function()
+	local _<close> = test.mock(io, 'large_file_size', 4)
+	local f<close> = test.tmpfile('.lua', 'text')
+
+	io.open_file(f.filename)
+
+	test.assert_equal(buffer.large_file, true)
+	test.assert_equal(buffer.lexer_language, 'text')
+	test.assert_equal(buffer:get_text(), 'text')
+	test.assert_equal(buffer:can_undo(), false)
+end)
+
+test('io.open_file should only disable line wrapping while showing large file buffers',
+	function()
+		local _<close> = test.mock(io, 'large_file_size', 4)
+		local _<close> = test.mock(view, 'wrap_mode', view.WRAP_WORD)
+		local f<close> = test.tmpfile('text')
+
+		io.open_file(f.filename)
+		local large_file_wrap_mode = view.wrap_mode
+		view.wrap_mode = view.WRAP_CHAR
+		view:goto_buffer(-1)
+		local wrap_mode = view.wrap_mode
+		view:goto_buffer(1)
+		local restored_large_file_wrap_mode = view.wrap_mode
+		view:goto_buffer(-1)
+
+		test.assert_equal(large_file_wrap_mode, view.WRAP_NONE)
+		test.assert_equal(wrap_mode, view.WRAP_WORD)
+		test.assert_equal(restored_large_file_wrap_mode, view.WRAP_CHAR)
+		test.assert_equal(view.wrap_mode, view.WRAP_WORD)
+	end)
+
 test('io.open_file should emit events.FILE_OPENED', function()
 	local f<close> = test.tmpfile()
 	local file_opened = test.stub()
@@ -86,6 +119,7 @@ test('io.open_file should allow opening non-existent files', function()
 	io.open_file(f.filename)
 
 	test.assert_equal(buffer.filename, f.filename)
+	test.assert_equal(buffer.encoding, 'UTF-8')
 end)
 
 test('io.open_file should handle UTF-8-encoded files', function()
@@ -121,6 +155,112 @@ test('io.open_file should handle UTF-16-encoded files', function()
 	test.assert_equal(buffer.encoding, 'UTF-16')
 end)
 
+test('io.open_file should load files in the background if async is true', function()
+	local contents = string.rep('text\n', 100000)
+	local f<close> = test.tmpfile(contents)
+	local file_opened = test.stub()
+	local _<close> = test.connect(events.FILE_OPENED, file_opened)
+
+	io.open_file(f.filename, true)
+	local loading = buffer.read_only
+
+	test.wait(function() return file_opened.called end)
+	test.assert(loading, 'buffer should be read-only while loading')
+	test.assert_equal(buffer.filename, f.filename)
+	test.assert_equal(buffer:get_text(), contents)
+	test.assert_equal(buffer.encoding, 'UTF-8')
+	test.assert_equal(buffer.read_only, false)
+	test.assert_equal(buffer.modify, false)
+end)
+
+test('buffer:save should not save a file that is loading in the background', function()
+	local contents = string.rep('text\n', 100000)
+	local f<close> = test.tmpfile(contents)
+	local file_opened = test.stub()
+	local _<close> = test.connect(events.FILE_OPENED, file_opened)
+
+	io.open_file(f.filename, true)
+	local saved = buffer:save()
+	test.wait(function() return file_opened.called end)
+
+	test.assert_equal(saved, nil)
+	test.assert_equal(f:read(), contents)
+	-- TODO: how to assert ui.statusbar_text was written to? Cannot mock it.
+end)
+
+test('io.open_file should stop loading in the background if the file cannot be read', function()
+	local f<close> = test.tmpfile(string.rep('text\n', 100000))
+	local error_handler = test.stub(false) -- halt propagation to default error handler
+	local _<close> = test.connect(events.ERROR, error_handler, 1)
+
+	io.open_file(f.filename, true)
+	f:delete()
+	test.wait(function() return error_handler.called end)
+
+	test.assert_equal(buffer.read_only, false)
+	test.assert(buffer:save(), 'should be able to save once loading stopped')
+end)
+
+test('io.open_file should fall back on other encodings for non-UTF-8 background loads', function()
+	local cp1252_contents = string.rep('text\n', 100000) .. '\xa9' -- the start is valid UTF-8
+	local f<close> = test.tmpfile(cp1252_contents)
+	local file_opened = test.stub()
+	local _<close> = test.connect(events.FILE_OPENED, file_opened)
+	local loader, loaders = io.loader, 0
+	local _<close> = test.mock(io, 'loader', function(...)
+		loaders = loaders + 1
+		return loader(...)
+	end)
+
+	io.open_file(f.filename, true)
+	test.wait(function() return file_opened.called end)
+
+	test.assert_equal(buffer.encoding, 'CP1252')
+	test.assert_equal(buffer:get_text(), cp1252_contents:iconv('UTF-8', 'CP1252'))
+	test.assert_equal(loaders, 1) -- continued from where UTF-8 validation failed
+end)
+
+test('io.load_into should convert multi-byte characters split across chunks', function()
+	local utf8_contents = 'a' .. string.rep('©', 40000)
+	local f<close> = test.tmpfile(utf8_contents) -- the first chunk ends with half of a '©'
+
+	io.load_into(buffer, f.filename, 'UTF-8')
+
+	test.assert_equal(buffer:get_text(), utf8_contents)
+	test.assert_equal(buffer:can_undo(), false)
+end)
+
+test('io.load_into should raise an error if conversion fails', function()
+	local f<close> = test.tmpfile('\xff')
+
+	local invalid_utf8 = function() io.load_into(buffer, f.filename, 'UTF-8') end
+
+	test.assert_raises(invalid_utf8, 'conversion failed')
+end)
+
+test('io.open_file should handle UTF-16-encoded files without a byte order mark', function()
+	local utf8_contents = 'Copyright ©'
+	local utf16le_contents = utf8_contents:iconv('UTF-16LE', 'UTF-8')
+	local f<close> = test.tmpfile(utf16le_contents)
+
+	io.open_file(f.filename)
+
+	test.assert_equal(buffer:get_text(), utf8_contents)
+	test.assert_equal(buffer.encoding, 'UTF-16LE')
+end)
+
+test('io.detect_encoding should detect encodings without converting', function()
+	local utf8_bom<close> = test.tmpfile('\xEF\xBB\xBFtext')
+	local utf8<close> = test.tmpfile(string.rep('©', 40000)) -- spans chunks
+	local cp1252<close> = test.tmpfile('Copyright \xA9')
+	local binary<close> = test.tmpfile('\x00\xff\xff')
+
+	test.assert_equal(io.detect_encoding(utf8_bom.filename), 'UTF-8')
+	test.assert_equal(io.detect_encoding(utf8.filename), 'UTF-8')
+	test.assert_equal(io.detect_encoding(cp1252.filename), nil)
+	test.assert_equal(select(2, io.detect_encoding(binary.filename)), true)
+end)
+
 test('io.open_file should handle binary files', function()
 	local binary_contents = '\x00\xff\xff'
 	local f<close> = test.tmpfile(binary_contents)
@@ -311,6 +451,19 @@ test('buffer:save should never write a trailing newline for binary files', funct
 	test.assert_equal(buffer:get_text(), binary_contents)
 end)
 
+test('buffer:save should leave the file unchanged if its text cannot be converted', function()
+	local contents = 'text'
+	local f<close> = test.tmpfile(contents, true)
+	buffer.encoding = 'CP1252'
+	buffer:append_text('中') -- not representable in CP1252
+
+	local save = function() buffer:save() end
+
+	test.assert_raises(save, 'conversion failed')
+	test.assert_equal(f:read(), contents)
+	test.assert_equal(buffer.modify, true)
+end)
+
 test('buffer.save should emit events.FILE_BEFORE_SAVE and events.FILE_AFTER_SAVE', function()
 	local f<close> = test.tmpfile(true)
 	f:delete() -- delete for tracking before and after events
@@ -333,6 +486,48 @@ test('buffer.save should emit events.FILE_BEFORE_SAVE and events.FILE_AFTER_SAVE
 	test.assert_equal(file_exists, {false, true})
 end)
 
+test('buffer:save_to should convert multi-byte characters split across chunks', function()
+	local f<close> = test.tmpfile()
+	local contents = 'a' .. string.rep('©', 40000) -- the first chunk ends with half of a '©'
+	buffer:append_text(contents)
+
+	local saved = buffer:save_to(f.filename, 'UTF-16LE')
+
+	test.assert_equal(saved, true)
+	test.assert_equal(f:read(), contents:iconv('UTF-16LE', 'UTF-8'))
+	test.assert_equal(buffer.modify, true)
+end)
+
+test('buffer:save_to should keep hard links and not leave temporary files behind', function()
+	local dir<close> = test.tmpdir{'file.txt'}
+	assert(lfs.link(dir / 'file.txt', dir / 'link.txt'))
+	io.open_file(dir / 'file.txt')
+	buffer:append_text('text')
+
+	buffer:save()
+
+	local f<close> = io.open(dir / 'link.txt', 'rb')
+	local files = {}
+	for filename in lfs.walk(dir.dirname) do files[#files + 1] = filename end
+	table.sort(files)
+	test.assert_equal(f:read('a'), 'text')
+	test.assert_equal(files, {dir / 'file.txt', dir / 'link.txt'})
+end)
+if WIN32 then skip('hard links are not supported') end
+
+test('buffer:save_to should not truncate a file with hard links if conversion fails', function()
+	local dir<close> = test.tmpdir{['file.txt'] = 'text'}
+	assert(lfs.link(dir / 'file.txt', dir / 'link.txt'))
+	buffer:append_text('中') -- cannot be represented in CP1252
+
+	local save = function() buffer:save_to(dir / 'file.txt', 'CP1252') end
+
+	test.assert_raises(save, 'conversion failed')
+	local f<close> = io.open(dir / 'file.txt', 'rb')
+	test.assert_equal(f:read('a'), 'text')
+end)
+if WIN32 then skip('hard links are not supported') end
+
 test('buffer.save_as should save with a given filename', function()
 	local f<close> = test.tmpfile()
 	f:delete() -- should not exist yet
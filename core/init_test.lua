@@ -97,6 +97,20 @@ test('move_buffer should allow moving a buffer forwards', function()
 	test.assert_equal(_BUFFERS[3].filename, f2.filename)
 end)
 
+test('move_buffer should keep buffer indices in sync for switching buffers', function()
+	local f1<close> = test.tmpfile('.1', true)
+	local f2<close> = test.tmpfile('.2', true)
+	local f3<close> = test.tmpfile('.3', true)
+
+	move_buffer(3, 1)
+	view:goto_buffer(1) -- f1
+	buffer:close() -- switches to f3
+	view:goto_buffer(1)
+
+	test.assert_equal(buffer.filename, f2.filename)
+	test.assert_equal(_BUFFERS[buffer], 2)
+end)
+
 -- Note: testing reset creates extra temporary _USERHOMEs and discards the test runner's
 -- events.QUIT handler.
 test('reset should reset the Lua state #skip', function()
@@ -141,3 +155,35 @@ test('timeout should repeatedly call a function as long as it returns true', fun
 		expected_duration, duration)
 end)
 if BSD then skip('luasocket was not built for this platform') end
+
+test('string.utf8_valid, string.utf8_count, and string.find_byte should scan text', function()
+	local long = string.rep('a', 100) .. 'Copyright ©' -- longer than a vector register
+
+	test.assert_equal(string.utf8_valid(long), true)
+	test.assert_equal(string.utf8_valid(long:sub(1, -2)), false) -- incomplete ©
+	test.assert_equal(string.utf8_valid('\xC0\x80'), false) -- overlong NUL
+	test.assert_equal(string.utf8_count(long), 111)
+	test.assert_equal(string.find_byte(long, 'C'), 101)
+	test.assert_equal(string.find_byte(long, 0x61, -12), nil)
+	test.assert_equal(string.find_byte('a\0b', 0), 2)
+end)
+
+test('string.iconv_stream should convert text split across chunks', function()
+	local text = 'Copyright ©'
+	local stream = string.iconv_stream('UTF-16LE', 'UTF-8')
+
+	local converted = stream:feed(text:sub(1, -2)) -- all but the last byte of '©'
+	converted = converted .. stream:feed(text:sub(-1)) .. stream:finish()
+
+	test.assert_equal(converted, text:iconv('UTF-16LE', 'UTF-8'))
+	test.assert_equal(string.iconv_stream('UTF-8', 'UTF-8'):feed(text), text)
+end)
+
+test('string.iconv_stream should raise an error if text ends mid-character', function()
+	local stream = string.iconv_stream('UTF-16LE', 'UTF-8')
+	stream:feed('\xC2') -- the first byte of '©'
+
+	local finish = function() stream:finish() end
+
+	test.assert_raises(finish, 'conversion failed')
+end)
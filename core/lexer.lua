@@ -25,10 +25,9 @@ local function get_lexer(buffer, current)
 	local style_at, name_of_style = buffer.style_at, buffer.name_of_style
 	local pos = buffer.current_pos
 	while pos > 0 do
-		local style = style_at[pos]
-		local lang = name_of_style(buffer, style):match('^whitespace%.(.+)$')
+		local lang = name_of_style(buffer, style_at[pos]):match('^whitespace%.(.+)$')
 		if lang then return lang end
-		repeat pos = pos - 1 until pos < 1 or style_at[pos] ~= style
+		pos = buffer:style_run(pos) - 1
 	end
 	return buffer.lexer_language
 end
@@ -85,6 +84,10 @@ local function style_of_name(buffer, name)
 	return lexer and lexer._TAGS[assert_type(name, 'string', 2):gsub('_', '.')] or view.STYLE_DEFAULT
 end
 
+-- List of styling and folding operations for `buffer:batch()`, reused by each highlighting
+-- pass instead of allocating a new one.
+local ops = {}
+
 --- Performs syntax highlighting in buffer *buffer* from *start_pos* to *end_pos*.
 -- Start from the beginning of the current style so the lexer can match the tag.
 -- For multilang lexers, start at whitespace since embedded languages have whitespace.[lang]
@@ -96,8 +99,12 @@ end
 local function highlight(buffer, start_pos, end_pos)
 	local style_at, ws = buffer.style_at, buffer._ws
 	local init_style = start_pos > 1 and style_at[start_pos - 1] or view.STYLE_DEFAULT
-	while start_pos > 1 and style_at[start_pos - 1] == init_style do start_pos = start_pos - 1 end
-	if ws then while start_pos > 1 and not ws[style_at[start_pos]] do start_pos = start_pos - 1 end end
+	if start_pos > 1 then start_pos = buffer:style_run(start_pos - 1) end
+	if ws then
+		while start_pos > 1 and not ws[style_at[start_pos]] do
+			start_pos = math.max(buffer:style_run(start_pos) - 1, 1)
+		end
+	end
 
 	-- Setup buffer-specific lexer fields.
 	local name_of_style, line_from_position = buffer.name_of_style, buffer.line_from_position
@@ -112,20 +119,26 @@ local function highlight(buffer, start_pos, end_pos)
 	-- Invoke the lexer and style text from the returned table of tags.
 	buffer:start_styling(start_pos, 0)
 	local styles = buffer.lexer:lex(buffer:text_range(start_pos, end_pos), init_style)
-	local set_styling, tags, pos = buffer.set_styling, buffer.lexer._TAGS, 1
+	local n, tags, pos = 0, buffer.lexer._TAGS, 1
 	for i = 1, #styles, 2 do
 		local e = styles[i + 1]
-		set_styling(buffer, e - pos, tags[styles[i]] or view.STYLE_DEFAULT) -- support legacy lexers
-		pos = e
+		local style = tags[styles[i]] or view.STYLE_DEFAULT -- support legacy lexers
+		ops[n + 1], ops[n + 2], ops[n + 3], n, pos = 'set_styling', e - pos, style, n + 3, e
 	end
-	buffer:set_styling(end_pos - (start_pos + pos - 1), view.STYLE_DEFAULT)
+	ops[n + 1], ops[n + 2], ops[n + 3] = 'set_styling', end_pos - (start_pos + pos - 1),
+		view.STYLE_DEFAULT
+	buffer:batch(ops, n + 3)
 
 	-- Invoke the folder and fold the text from the returned table of fold levels.
 	local line = buffer:line_from_position(start_pos)
 	start_pos = buffer:position_from_line(line)
 	local level = buffer.fold_level[line] & buffer.FOLDLEVELNUMBERMASK
 	local folds = buffer.lexer:fold(buffer:text_range(start_pos, end_pos), line, level)
-	for line, level in pairs(folds) do buffer.fold_level[line] = level end
+	n = 0
+	for line, level in pairs(folds) do
+		ops[n + 1], ops[n + 2], ops[n + 3], n = 'fold_level', line, level, n + 3
+	end
+	buffer:batch(ops, n)
 end
 
 local mutex
@@ -36,6 +36,16 @@ local ui = ui
 -- buffer is open.
 -- @field tabs
 
+--- The number of hidden views used for working with buffers that are not shown in any view.
+-- Buffers stay loaded in these views until the least recently used one is needed for another
+-- buffer, so increasing this number can speed up code that alternates between more buffers
+-- (e.g. iterating over `_BUFFERS`). The maximum is 16.
+-- The default value is `4`.
+-- @field buffer_views
+
+--- The number of times a buffer was loaded into one of `ui.buffer_views`. (Read-only)
+-- @field buffer_view_rebinds
+
 --- Option for `ui.tabs` that always shows the tab bar, even if only one buffer is open.
 ui.SHOW_ALL_TABS = 2 -- ui.tabs options must be greater than 1
 if CURSES then ui.tabs = false end -- not supported right now
@@ -45,6 +55,11 @@ if CURSES then ui.tabs = false end -- not supported right now
 -- The default value is `true`.
 ui.buffer_list_zorder = true
 
+--- Whether or not to show the median and 99th percentile keystroke latencies from
+-- `ui.latency_stats()` in the buffer statusbar.
+-- The default value is `false`.
+ui.show_latency = false
+
 --- Helper function for getting the print view.
 local function get_print_view(type)
 	for _, view in ipairs(_VIEWS) do if view.buffer._type == type then return view end end
@@ -300,9 +315,8 @@ end)
 events.connect(events.APPLEEVENT_ODOC,
 	function(uri) return events.emit(events.URI_DROPPED, 'file://' .. uri) end)
 
--- Sets buffer statusbar text.
-events.connect(events.UPDATE_UI, function(updated)
-	if updated & 3 == 0 then return end -- ignore scrolling
+-- Sets buffer statusbar text once the caret or selection stops changing.
+events.connect_deferred(events.UPDATE_UI, function()
 	local text = not CURSES and '%s %d/%d    %s %d    %s    %s    %s    %s' or
 		'%s %d/%d  %s %d  %s  %s  %s  %s'
 	local pos = buffer.current_pos
@@ -313,9 +327,14 @@ events.connect(events.UPDATE_UI, function(updated)
 	local tabs = string.format('%s %d', buffer.use_tabs and _L['Tabs:'] or _L['Spaces:'],
 		buffer.tab_width)
 	local encoding = buffer.encoding or ''
+	if ui.show_latency then
+		local stats = ui.latency_stats()
+		encoding = string.format('%s%s%.1f/%.1fms', encoding, not CURSES and '    ' or '  ',
+			stats.p50 * 1000, stats.p99 * 1000)
+	end
 	ui.buffer_statusbar_text = string.format(text, _L['Line:'], line, max, _L['Col:'], col, lang, eol,
 		tabs, encoding)
-end)
+end, {filter = function(updated) return updated & 3 > 0 end}) -- ignore scrolling
 
 --- Save buffer properties.
 local function save_buffer_state()
@@ -503,3 +522,16 @@ events.connect(events.INITIALIZED, function() events.disconnect(events.ERROR, te
 -- Emits `events.SUSPEND` and `events.RESUME`.
 -- @usage keys['ctrl+z'] = ui.suspend
 -- @function suspend
+
+--- Returns statistics for the latencies of the last 256 keystrokes, from the platform receiving
+-- a key to the next paint of a view.
+-- Keystrokes that do not change a view within a second (e.g. modifier keys) are not sampled.
+-- @param[opt=false] reset Whether or not to clear the samples after returning statistics.
+-- @return table with `count`, `p50`, `p90`, `p99`, and `max` fields for total latencies,
+--	`lua`, `scintilla`, and `redraw` fields for mean Lua key handling, Scintilla processing,
+--	and redraw times, and a `histogram` field that is a list of 8 sample counts for latencies
+--	under 1, 2, 4, 8, 16, 32, and 64 milliseconds, and 64 milliseconds or more. All times are
+--	in seconds.
+-- @see show_latency
+-- @usage ui.print(ui.latency_stats().p99)
+-- @function latency_stats
@@ -524,3 +524,55 @@ test('ui.goto_view should focus a large relative view with wrapping (right)', fu
 
 	test.assert_equal(_VIEWS[view], 2)
 end)
+
+test('ui.buffer_views should keep hidden buffers loaded while alternating between them', function()
+	local buffer1 = buffer
+	buffer.new()
+	local buffer2 = buffer
+	buffer.new()
+
+	local function count_rebinds(n)
+		local _<close> = test.mock(ui, 'buffer_views', n)
+		local rebinds = ui.buffer_view_rebinds
+		for _ = 1, 10 do local _ = buffer1.length + buffer2.length end
+		return ui.buffer_view_rebinds - rebinds
+	end
+
+	test.assert_equal(count_rebinds(1), 20)
+	test.assert(count_rebinds(2) <= 2, 'buffers should only be loaded once')
+end)
+
+test('ui.latency_stats should summarize and optionally reset keystroke latencies', function()
+	ui.latency_stats(true)
+
+	local stats = ui.latency_stats()
+
+	test.assert_equal(stats.count, 0)
+	test.assert_equal(stats.p99, 0)
+	test.assert_equal(stats.histogram, {0, 0, 0, 0, 0, 0, 0, 0})
+end)
+
+test('ui.latency_stats should sample a keystroke from its emission until the next paint', function()
+	local key<close> = test.tmpfile('.bin', test.trace{events.KEY, string.byte(QT and 'A' or 'a'), 0})
+	local recorded_paint<close> = test.tmpfile('.bin', test.trace{events.PAINTED})
+	local painted = test.stub()
+	ui.latency_stats(true)
+
+	events.replay(key.filename)
+	events.replay(recorded_paint.filename) -- should not finish the sample
+	local unpainted_count = ui.latency_stats().count
+	local _<close> = test.connect(events.PAINTED, painted)
+	test.wait(function() return painted.called end)
+
+	local stats = ui.latency_stats()
+	test.assert_equal(unpainted_count, 0)
+	test.assert_equal(stats.count, 1)
+	test.assert_equal(stats.p50, stats.max)
+	local histogram_count = 0
+	for _, count in ipairs(stats.histogram) do histogram_count = histogram_count + count end
+	test.assert_equal(histogram_count, 1)
+	test.assert(stats.lua >= 0 and stats.scintilla >= 0 and stats.redraw >= 0,
+		'part times should not be negative')
+	test.assert(math.abs(stats.lua + stats.scintilla + stats.redraw - stats.max) < 1e-9,
+		'part times should add up to the total time')
+end)
@@ -549,9 +549,9 @@ events.connect(events.KEYPRESS, function(key)
 	return true -- prevent typing
 end, 1)
 
--- Highlights matching braces.
-events.connect(events.UPDATE_UI, function(updated)
-	if updated & 3 == 0 then return end -- ignore scrolling
+-- Highlights matching braces once the caret stops moving.
+events.connect_deferred(events.UPDATE_UI, function()
+	if buffer.large_file then return end
 	if brace_matches[buffer.char_at[buffer.current_pos]] then
 		local match = buffer:brace_match(buffer.current_pos, 0)
 		local f = match ~= -1 and view.brace_highlight or view.brace_bad_light
@@ -559,11 +559,11 @@ events.connect(events.UPDATE_UI, function(updated)
 		return
 	end
 	view:brace_bad_light(-1)
-end)
+end, {filter = function(updated) return updated & 3 > 0 end}) -- ignore scrolling
 
--- Highlight all instances of the current or selected word.
-events.connect(events.UPDATE_UI, function(updated)
-	if updated & buffer.UPDATE_SELECTION == 0 or ui.find.active then return end
+-- Highlight all instances of the current or selected word once the selection stops changing.
+events.connect_deferred(events.UPDATE_UI, function()
+	if ui.find.active or buffer.large_file then return end
 	if M.highlight_words == M.HIGHLIGHT_NONE then return end
 	buffer.indicator_current = M.INDIC_HIGHLIGHT
 	buffer:indicator_clear_range(1, buffer.length)
@@ -580,11 +580,14 @@ events.connect(events.UPDATE_UI, function(updated)
 	if word == '' then return end
 	buffer.search_flags = buffer.FIND_MATCHCASE | buffer.FIND_WHOLEWORD
 	buffer:target_whole_document()
+	local fills, n = {}, 0
 	while buffer:search_in_target(word) ~= -1 do
-		buffer:indicator_fill_range(buffer.target_start, buffer.target_end - buffer.target_start)
-		buffer:set_target_range(buffer.target_end, buffer.length + 1)
+		local s, e = buffer.target_start, buffer.target_end
+		fills[n + 1], fills[n + 2], fills[n + 3], n = 'indicator_fill_range', s, e - s, n + 3
+		buffer:set_target_range(e, buffer.length + 1)
 	end
-end)
+	buffer:batch(fills)
+end, {filter = function(updated) return updated & buffer.UPDATE_SELECTION > 0 end})
 
 -- Enables and disables bracketed paste mode in curses and disables auto-pair and auto-indent
 -- while pasting.
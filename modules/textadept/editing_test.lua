@@ -756,6 +756,7 @@ end)
 local function process_selection_update()
 	ui.update()
 	if CURSES then events.emit(events.UPDATE_UI, buffer.UPDATE_SELECTION) end
+	events.flush_deferred()
 end
 
 --- Returns a list of words highlighted by editing.INDIC_HIGHLIGHT.
@@ -301,7 +301,9 @@ local function find_in_files()
 			buffer:target_whole_document()
 			while buffer:search_in_target(text) ~= -1 do
 				found = true
-				if binary == nil then binary = buffer:text_range(1, 65536):find('\0') end
+				if binary == nil then
+					binary = string.find_byte(buffer:text_view(1, math.min(buffer.length + 1, 65536)), 0)
+				end
 				if binary then
 					print(string.format('%s:1:%s', utf8_filenames[i], _L['Binary file matches.']))
 					break
@@ -346,20 +348,21 @@ end)
 
 -- Count and optionally highlight all found occurrences.
 events.connect(events.FIND_RESULT_FOUND, function(text, wrapped)
-	local count, current = 0, 1
+	local count, current, fills, n = 0, 1, {}, 0
 	buffer.search_flags = get_flags()
 	buffer:target_whole_document()
 	while buffer:search_in_target(text) ~= -1 do
 		local s, e = buffer.target_start, buffer.target_end
 		if s == e then e = e + 1 end -- prevent loops for zero-length results
 		if M.highlight_all_matches and e - s > 1 and not is_ff_buf(buffer) then
-			buffer:indicator_fill_range(s, e - s)
+			fills[n + 1], fills[n + 2], fills[n + 3], n = 'indicator_fill_range', s, e - s, n + 3
 		end
 		count = count + 1
 		if s == buffer.current_pos then current = count end
 		if e > buffer.length then break end
 		buffer:set_target_range(e, buffer.length + 1)
 	end
+	buffer:batch(fills)
 	local message = string.format('%s %d/%d', _L['Match'], current, count)
 	if wrapped then message = string.format('%s (%s)', message, _L['Search wrapped']) end
 	ui.statusbar_text = message
@@ -94,17 +94,20 @@ local function print_output(silent, ...)
 	local buffer = get_output_buffer()
 	local last_line = buffer and buffer.line_count or 1
 	buffer = ui[silent and 'output_silent' or 'output'](...)
-	for i = last_line, buffer.line_count do
-		local line_state = buffer.line_state[i]
+	local ops, n = {}, 0
+	for i, line_state in ipairs(buffer:line_states(last_line, buffer.line_count)) do
 		if line_state > 0 then
-			buffer:marker_add(i, line_state_marks[line_state])
-			local s, e = buffer:position_from_line(i), buffer.line_end_position[i]
-			while s < e and buffer:name_of_style(buffer.style_at[s]) ~= 'message' do s = s + 1 end
-			while e > s and buffer:name_of_style(buffer.style_at[e]) ~= 'message' do e = e - 1 end
-			buffer.indicator_current = line_state_indics[line_state]
-			buffer:indicator_fill_range(s, e - s + 1)
+			local line = last_line + i - 1
+			local first, last = buffer:position_from_line(line), buffer.line_end_position[line]
+			local styles, s, e = buffer:styles_in_range(first, last + 1), first, last
+			while s < e and buffer:name_of_style(styles[s - first + 1]) ~= 'message' do s = s + 1 end
+			while e > s and buffer:name_of_style(styles[e - first + 1]) ~= 'message' do e = e - 1 end
+			ops[n + 1], ops[n + 2], ops[n + 3] = 'marker_add', line, line_state_marks[line_state]
+			ops[n + 4], ops[n + 5] = 'indicator_current', line_state_indics[line_state]
+			ops[n + 6], ops[n + 7], ops[n + 8], n = 'indicator_fill_range', s, e - s + 1, n + 8
 		end
 	end
+	buffer:batch(ops)
 end
 for _, event in ipairs(run_events) do
 	events.connect(event, function(...)
@@ -348,13 +351,11 @@ end)
 -- @param tag String tag name, either 'filename', 'line', 'column', or 'message'.
 -- @return tagged text or nil if none was found
 local function get_tagged_text(line_num, tag)
-	for pos = buffer:position_from_line(line_num), buffer.line_end_position[line_num] do
-		local style = buffer.style_at[pos]
-		if buffer:name_of_style(style) == tag then
-			local s, e = pos, pos
-			repeat e = e + 1 until e > buffer.length or buffer.style_at[e] ~= style
-			return buffer:text_range(s, e)
-		end
+	local pos, line_end = buffer:position_from_line(line_num), buffer.line_end_position[line_num]
+	while pos <= line_end do
+		local _, e = buffer:style_run(pos)
+		if buffer:name_of_style(buffer.style_at[pos]) == tag then return buffer:text_range(pos, e) end
+		pos = e
 	end
 end
 
@@ -0,0 +1,37 @@
+-- Copyright 2007-2024 Mitchell. See LICENSE.
+
+-- Benchmarks Textadept's text scanning kernels against their Lua equivalents and prints
+-- throughput in GB/s.
+-- Usage: textadept -L scripts/bench_text.lua [megabytes]
+
+local size = (tonumber(arg[1]) or 256) * 1024 * 1024
+local ascii = string.rep('0123456789abcdef', size // 16)
+local utf8_text = string.rep('©€', size // 5) -- 2- and 3-byte characters
+local runs = 5
+
+--- Returns the best throughput in GB/s of *runs* calls to function *f* with string *text*.
+local function bench(f, text)
+	local best = math.huge
+	for _ = 1, runs do
+		local start = os.clock()
+		f(text)
+		best = math.min(best, os.clock() - start)
+	end
+	return #text / best / 1e9
+end
+
+local benchmarks = {
+	{'string.utf8_valid (ASCII)', string.utf8_valid, utf8.len, ascii},
+	{'string.utf8_valid (UTF-8)', string.utf8_valid, utf8.len, utf8_text},
+	{'string.utf8_count (UTF-8)', string.utf8_count, utf8.len, utf8_text},
+	{
+		'string.find_byte (no match)', function(text) return string.find_byte(text, 0) end,
+		function(text) return text:find('\0', 1, true) end, ascii
+	}
+}
+
+print(string.format('%-28s %10s %10s', 'kernel', 'GB/s', 'Lua GB/s'))
+for _, benchmark in ipairs(benchmarks) do
+	local name, f, lua_f, text = table.unpack(benchmark)
+	print(string.format('%-28s %10.2f %10.2f', name, bench(f, text), bench(lua_f, text)))
+end
@@ -188,9 +188,13 @@ local f = io.open('../core/iface.lua', 'wb')
 f:write([=[
 -- Copyright 2007-2024 Mitchell. See LICENSE.
 
--- Scintilla constants, functions, and properties.
+-- Scintilla constants and events.
+-- Scintilla functions and properties are looked up in C (see src/iface.h). Textadept creates
+-- this module's table with a metatable that provides their interface tables on demand.
 -- Do not modify anything in this module. Doing so will have unpredictable consequences.
-local M = {
+local M = _SCINTILLA
+
+for k, v in pairs{
 
 ]=])
 f:write([[
@@ -199,39 +203,10 @@ f:write([[
 f:write(table.concat(constants, ','))
 f:write(',\n\n')
 f:write([[
--- Scintilla function names to tables containing their IDs, return types, wParam types, and
--- lParam types. Types are as follows:
---
--- - `0`: Void.
--- - `1`: Integer.
--- - `2`: Length of the given lParam string.
--- - `3`: Integer position.
--- - `4`: Color, in "0xBBGGRR" format or "0xAABBGGRR" format where supported.
--- - `5`: Boolean `true` or `false`.
--- - `6`: Bitmask of Scintilla key modifiers and a key value.
--- - `7`: String parameter.
--- - `8`: String return value.
-]])
-for _, func in ipairs(functions) do
-	f:write(string.format('%s={%d,%d,%d,%d},', func, table.unpack(functions[func])))
-end
-f:write('\n\n')
-f:write([[
--- Scintilla property names to table values containing their "get" function IDs, "set" function
--- IDs, return types, and wParam types. (The last field is currently unused and merely serves
--- to distinguish between a function or property table.)
--- The wParam type will be non-zero if the property is indexable.
--- Types are the same as in the functions tables.
-]])
-for _, property in ipairs(properties) do
-	f:write(string.format('%s={%d,%d,%d,%d,0},', property, table.unpack(properties[property])))
-end
-f:write('\n\n')
-f:write([[
 -- Scintilla event IDs to tables of event names and event parameters.
 ]])
 for _, event in ipairs(events) do f:write(string.format('[%s]={%s},', event, events[event])) end
-f:write('\n\n}\n\n')
+f:write('\n\n} do M[k] = v end\n\n')
 f:write([[
 local marker_number, indic_number, list_type, image_type = 0, 0, 0, 0
 
@@ -264,3 +239,154 @@ end
 return M
 ]])
 f:close()
+
+-- Scintilla function and property names to their C interface entries. Properties take
+-- precedence over functions of the same name.
+local entries, names = {}, {}
+for _, func in ipairs(functions) do
+	entries[func] = string.format('{"%s",%d,0,%d,%d,%d,false}', func, table.unpack(functions[func]))
+end
+for _, property in ipairs(properties) do
+	entries[property] = string.format('{"%s",%d,%d,%d,%d,0,true}', property,
+		table.unpack(properties[property]))
+end
+for name in pairs(entries) do names[#names + 1] = name end
+table.sort(names)
+
+--- Returns the 32-bit FNV-1a hash of string *name* using integer *seed*.
+-- This must match `iface_hash()` in the generated C header.
+local function hash(name, seed)
+	local h = 2166136261 ~ seed
+	for i = 1, #name do h = ((h ~ name:byte(i)) * 16777619) & 0xFFFFFFFF end
+	return h
+end
+
+-- Compute a minimal perfect hash: hash names into buckets, and then, starting with the largest
+-- bucket, find for each bucket a displacement (a hash seed) that maps all of its names into
+-- unused slots.
+local size, num_buckets = #names, (#names + 3) // 4
+local buckets, order, displacements, slots = {}, {}, {}, {}
+for i = 1, num_buckets do buckets[i], order[i], displacements[i] = {}, i, 0 end
+for _, name in ipairs(names) do
+	local bucket = buckets[hash(name, 0) % num_buckets + 1]
+	bucket[#bucket + 1] = name
+end
+table.sort(order, function(a, b)
+	if #buckets[a] ~= #buckets[b] then return #buckets[a] > #buckets[b] end
+	return a < b
+end)
+local function place(bucket, d)
+	local indices, used = {}, {}
+	for i, name in ipairs(bucket) do
+		local index = hash(name, d) % size + 1
+		if slots[index] or used[index] then return nil end
+		indices[i], used[index] = index, true
+	end
+	return indices
+end
+for _, i in ipairs(order) do
+	local bucket, d, indices = buckets[i], 0, nil
+	if #bucket == 0 then break end -- all remaining buckets are empty too
+	repeat d, indices = d + 1, place(bucket, d + 1) until indices
+	for j, name in ipairs(bucket) do slots[indices[j]] = name end
+	displacements[i] = d
+end
+
+f = io.open('../src/iface.h', 'wb')
+f:write([[
+// Copyright 2007-2024 Mitchell. See LICENSE.
+// Generated by scripts/gen_iface.lua. Do not modify.
+
+// Scintilla function and property names mapped to their message IDs and types.
+// Names are looked up via a minimal perfect hash, so resolving one takes two string hashes and
+// one string comparison, and does not touch the Lua heap.
+// Types are as follows:
+//
+// - `0`: Void.
+// - `1`: Integer.
+// - `2`: Length of the given lParam string.
+// - `3`: Integer position.
+// - `4`: Color, in "0xBBGGRR" format or "0xAABBGGRR" format where supported.
+// - `5`: Boolean `true` or `false`.
+// - `6`: Bitmask of Scintilla key modifiers and a key value.
+// - `7`: String parameter.
+// - `8`: String return value.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// A Scintilla function or property.
+// For functions, `msg` is the message ID, and `rtype`, `wtype`, and `ltype` are the return,
+// wParam, and lParam types.
+// For properties, `msg` and `set_msg` are the "get" and "set" message IDs (0 if there is none),
+// `rtype` is the property's type, and `wtype` is its index type (0 if it is not indexable).
+typedef struct {
+	const char *name;
+	int msg, set_msg, rtype, wtype, ltype;
+	bool property;
+} IfaceEntry;
+
+]])
+f:write(string.format('#define IFACE_SIZE %d\n#define IFACE_BUCKETS %d\n\n', size, num_buckets))
+f:write('static const int iface_displacements[IFACE_BUCKETS] = {')
+f:write(table.concat(displacements, ','))
+f:write('};\n\n')
+f:write('static const IfaceEntry iface_entries[IFACE_SIZE] = {\n')
+for _, name in ipairs(slots) do f:write('\t', entries[name], ',\n') end
+f:write('};\n\n')
+f:write([[
+// Returns the 32-bit FNV-1a hash of the given name, using the given seed.
+static uint32_t iface_hash(const char *name, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (const unsigned char *p = (const unsigned char *)name; *p; p++) h = (h ^ *p) * 16777619u;
+	return h;
+}
+
+// Returns the interface entry for the given Scintilla function or property name, or NULL if
+// there is none.
+static const IfaceEntry *find_iface(const char *name) {
+	int d = iface_displacements[iface_hash(name, 0) % IFACE_BUCKETS];
+	const IfaceEntry *entry = &iface_entries[iface_hash(name, d) % IFACE_SIZE];
+	return strcmp(entry->name, name) == 0 ? entry : NULL;
+}
+]])
+
+-- Scintilla notification fields passed to event handlers.
+local fields, max_fields, seen = {}, 0, {}
+for _, event in ipairs(events) do
+	local n = 0
+	for field in events[event]:gmatch(',"([%w_]+)"') do
+		if not seen[field] then fields[#fields + 1], seen[field] = field, true end
+		n = n + 1
+	end
+	if n > max_fields then max_fields = n end
+end
+table.sort(fields)
+for i = 1, #fields do fields[i] = 'NOTIFY_' .. fields[i]:upper() end
+f:write('\n// Scintilla notification fields passed to event handlers.\n')
+f:write('enum { NOTIFY_NONE, ', table.concat(fields, ', '), ' };\n\n')
+f:write(string.format([[
+// A Scintilla notification's event name and the notification fields passed to its handlers,
+// in order.
+typedef struct {
+	const char *name;
+	int fields[%d]; // terminated by NOTIFY_NONE
+} IfaceEvent;
+
+]], max_fields + 1))
+local base = tonumber(events[1])
+f:write(string.format('#define IFACE_EVENT_BASE %d\n#define IFACE_EVENT_COUNT %d\n\n', base,
+	tonumber(events[#events]) - base + 1))
+f:write('// Indexed by notification code minus IFACE_EVENT_BASE.\n')
+f:write('static const IfaceEvent iface_events[IFACE_EVENT_COUNT] = {\n')
+for _, event in ipairs(events) do
+	local name, params = events[event]:match('^"([%w_]+)"(.*)$')
+	local ids = {}
+	for field in params:gmatch('"([%w_]+)"') do ids[#ids + 1] = 'NOTIFY_' .. field:upper() end
+	if #ids == 0 then ids[1] = 'NOTIFY_NONE' end
+	f:write(string.format('\t[%d] = {"%s", {%s}},\n', tonumber(event) - base, name,
+		table.concat(ids, ', ')))
+end
+f:write('};\n')
+f:close()
@@ -0,0 +1,710 @@
+// Copyright 2007-2024 Mitchell. See LICENSE.
+// Generated by scripts/gen_iface.lua. Do not modify.
+
+// Scintilla function and property names mapped to their message IDs and types.
+// Names are looked up via a minimal perfect hash, so resolving one takes two string hashes and
+// one string comparison, and does not touch the Lua heap.
+// Types are as follows:
+//
+// - `0`: Void.
+// - `1`: Integer.
+// - `2`: Length of the given lParam string.
+// - `3`: Integer position.
+// - `4`: Color, in "0xBBGGRR" format or "0xAABBGGRR" format where supported.
+// - `5`: Boolean `true` or `false`.
+// - `6`: Bitmask of Scintilla key modifiers and a key value.
+// - `7`: String parameter.
+// - `8`: String return value.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// A Scintilla function or property.
+// For functions, `msg` is the message ID, and `rtype`, `wtype`, and `ltype` are the return,
+// wParam, and lParam types.
+// For properties, `msg` and `set_msg` are the "get" and "set" message IDs (0 if there is none),
+// `rtype` is the property's type, and `wtype` is its index type (0 if it is not indexable).
+typedef struct {
+	const char *name;
+	int msg, set_msg, rtype, wtype, ltype;
+	bool property;
+} IfaceEntry;
+
+#define IFACE_SIZE 606
+#define IFACE_BUCKETS 152
+
+static const int iface_displacements[IFACE_BUCKETS] = {464,0,12,27,49,20,7,1,1,5,131,9,1,159,78,3,80,107,8,15,115,110,39,17,13,113,1,120,1,6,79,4,27,145,93,19,3,2,1,3,104,14,86,8,17,1,6,2,98,278,1,41,40,1,5,15,63,13,18,265,55,19,10,4,6,11,7,295,5,13,32,5,6,58,1,40,5,23,15,107,0,165,1,245,94,22,114,40,732,859,12,252,264,7,293,781,208,132,1727,146,338,56,339,731,7,452,62,70,71,123,54,637,10,43,57,2,11,110,1214,200,40,91,43,1,2,620,1906,3,24,78,17,57,625,75,5,0,655,516,895,66,43,1,206,2445,363,3,119,134,67,4112,11,5483};
+
+static const IfaceEntry iface_entries[IFACE_SIZE] = {
+	{"goto_line",2024,0,0,3,0,false},
+	{"x_offset",2398,2397,1,0,0,true},
+	{"indicator_value_at",2507,0,1,3,3,false},
+	{"drop_selection_n",2671,0,0,3,0,false},
+	{"toggle_fold",2231,0,0,3,0,false},
+	{"marker_delete",2044,0,0,3,3,false},
+	{"line_up_rect_extend",2427,0,0,0,0,false},
+	{"additional_selection_typing",2566,2565,5,0,0,true},
+	{"set_visible_policy",2394,0,0,1,1,false},
+	{"get_text_range",2162,0,3,0,10,false},
+	{"colorize",4003,0,0,3,3,false},
+	{"back_space_un_indents",2263,2262,5,0,0,true},
+	{"vc_home_display",2652,0,0,0,0,false},
+	{"direct_status_function",2772,0,1,0,0,true},
+	{"style_hot_spot",2493,2409,5,3,0,true},
+	{"allocate_line_character_index",2711,0,0,1,0,false},
+	{"page_down",2322,0,0,0,0,false},
+	{"indent",2123,2122,1,0,0,true},
+	{"print_wrap_mode",2407,2406,1,0,0,true},
+	{"select_all",2013,0,0,0,0,false},
+	{"wrap_start_indent",2465,2464,1,0,0,true},
+	{"main_selection",2575,2574,3,0,0,true},
+	{"selection_duplicate",2469,0,0,0,0,false},
+	{"rectangular_selection_caret",2589,2588,3,0,0,true},
+	{"indic_style",2081,2080,1,3,0,true},
+	{"para_up_extend",2416,0,0,0,0,false},
+	{"describe_property",4016,0,0,7,8,false},
+	{"margin_back_n",2251,2250,4,3,0,true},
+	{"margin_styles",2535,2534,8,3,0,true},
+	{"tag",2616,0,8,1,0,true},
+	{"margin_left",2156,2155,1,0,0,true},
+	{"marker_stroke_width",0,2297,1,3,0,true},
+	{"position_from_line",2167,0,3,3,0,false},
+	{"virtual_space_options",2597,2596,1,0,0,true},
+	{"representation",2666,2665,8,7,0,true},
+	{"mouse_selection_rectangular_switch",2669,2668,5,0,0,true},
+	{"set_sel",2160,0,0,3,3,false},
+	{"indicator_current",2501,2500,3,0,0,true},
+	{"marker_back_selected",0,2292,4,3,0,true},
+	{"set_y_caret_policy",2403,0,0,1,1,false},
+	{"style_character_set",2490,2066,1,3,0,true},
+	{"word_left",2308,0,0,0,0,false},
+	{"get_styled_text_full",2778,0,3,0,11,false},
+	{"selection_mode",2423,2422,1,0,0,true},
+	{"style_italic",2484,2054,5,3,0,true},
+	{"fold_line",2237,0,0,3,1,false},
+	{"wrap_mode",2269,2268,1,0,0,true},
+	{"selection_hidden",2088,0,5,0,0,true},
+	{"undo_detach",2794,2793,1,0,0,true},
+	{"mouse_wheel_captures",2697,2696,5,0,0,true},
+	{"char_right_extend",2307,0,0,0,0,false},
+	{"style_changeable",2492,2099,5,3,0,true},
+	{"line_duplicate",2404,0,0,0,0,false},
+	{"scroll_range",2569,0,0,3,3,false},
+	{"line_delete",2338,0,0,0,0,false},
+	{"set_target_range",2686,0,0,3,3,false},
+	{"indicator_start",2508,0,3,3,3,false},
+	{"layout_cache",2273,2272,1,0,0,true},
+	{"marker_enable_highlight",2293,0,0,5,0,false},
+	{"set_selection",2572,0,0,3,3,false},
+	{"auto_c_drop_rest_of_word",2271,2270,5,0,0,true},
+	{"technology",2631,2630,1,0,0,true},
+	{"style_back",2482,2052,4,3,0,true},
+	{"indic_flags",2685,2684,1,3,0,true},
+	{"brace_match",2353,0,3,3,1,false},
+	{"allocate_sub_styles",4020,0,1,1,1,false},
+	{"auto_c_separator",2107,2106,1,0,0,true},
+	{"new_line",2329,0,0,0,0,false},
+	{"font_locale",2761,2760,8,0,0,true},
+	{"current_pos",2008,2141,3,0,0,true},
+	{"tags_of_style",4031,0,0,3,8,false},
+	{"del_word_right_end",2518,0,0,0,0,false},
+	{"multiple_select_add_next",2688,0,0,0,0,false},
+	{"word_part_right_extend",2393,0,0,0,0,false},
+	{"line_copy",2455,0,0,0,0,false},
+	{"home",2312,0,0,0,0,false},
+	{"line_transpose",2339,0,0,0,0,false},
+	{"undo_save_point",2792,2791,1,0,0,true},
+	{"search_next",2367,0,3,1,7,false},
+	{"home_display",2345,0,0,0,0,false},
+	{"length",2006,0,1,0,0,true},
+	{"line_indent_position",2128,0,3,3,0,true},
+	{"copy_range",2419,0,0,3,3,false},
+	{"edge_color",2364,2365,4,0,0,true},
+	{"marker_define",2040,0,0,3,1,false},
+	{"document_start",2316,0,0,0,0,false},
+	{"auto_c_fill_ups",0,2112,7,0,0,true},
+	{"auto_c_style",2120,2109,1,0,0,true},
+	{"lexer",4002,0,1,0,0,true},
+	{"change_lexer_state",2617,0,1,3,3,false},
+	{"idle_styling",2693,2692,1,0,0,true},
+	{"indic_hover_fore",2683,2682,4,3,0,true},
+	{"stuttered_page_down",2437,0,0,0,0,false},
+	{"caret_fore",2138,2069,4,0,0,true},
+	{"get_styled_text",2015,0,3,0,10,false},
+	{"selection_is_rectangle",2372,0,5,0,0,true},
+	{"undo_action_text",2804,0,8,1,0,true},
+	{"allocate",2446,0,0,3,0,false},
+	{"marker_layer",2734,2735,1,3,0,true},
+	{"add_undo_action",2560,0,0,1,1,false},
+	{"margins",2253,2252,1,0,0,true},
+	{"sub_styles_length",4022,0,1,1,0,true},
+	{"get_line",2153,0,0,3,8,false},
+	{"copy_allow_line",2519,0,0,0,0,false},
+	{"clear_cmd_key",2071,0,0,6,0,false},
+	{"set_empty_selection",2556,0,0,3,0,false},
+	{"style_reset_default",2058,0,0,0,0,false},
+	{"char_left_extend",2305,0,0,0,0,false},
+	{"extra_ascent",2526,2525,1,0,0,true},
+	{"annotation_text",2541,2540,8,3,0,true},
+	{"set_styling",2033,0,0,2,3,false},
+	{"supports_feature",2750,0,5,1,0,true},
+	{"replace_rectangular",2771,0,0,2,7,false},
+	{"can_redo",2016,0,5,0,0,false},
+	{"del_word_right",2336,0,0,0,0,false},
+	{"fold_parent",2225,0,3,3,0,true},
+	{"indicator_end",2509,0,3,3,3,false},
+	{"brace_bad_light",2352,0,0,3,0,false},
+	{"line_end_types_supported",4018,0,1,0,0,true},
+	{"set_save_point",2014,0,0,0,0,false},
+	{"target_end",2193,2192,3,0,0,true},
+	{"line_end_extend",2315,0,0,0,0,false},
+	{"margin_type_n",2241,2240,1,3,0,true},
+	{"line_length",2350,0,1,3,0,false},
+	{"wrap_indent_mode",2473,2472,1,0,0,true},
+	{"char_right_rect_extend",2429,0,0,0,0,false},
+	{"style_from_sub_style",4027,0,1,1,0,true},
+	{"element_color",2754,2753,4,1,0,true},
+	{"margin_style_offset",2538,2537,3,0,0,true},
+	{"fold_display_text_style",2707,2701,1,0,0,true},
+	{"word_part_left",2390,0,0,0,0,false},
+	{"auto_c_stops",2105,0,0,0,7,false},
+	{"selection_n_anchor_virtual_space",2583,2582,1,3,0,true},
+	{"delete_range",2645,0,0,3,2,false},
+	{"goto_pos",2025,0,0,3,0,false},
+	{"margin_options",2557,2539,1,0,0,true},
+	{"find_indicator_flash",2641,0,0,3,3,false},
+	{"sel_alpha",2477,2478,1,0,0,true},
+	{"line_end_display",2347,0,0,0,0,false},
+	{"sub_style_bases",4026,0,8,0,0,true},
+	{"auto_c_active",2102,0,5,0,0,false},
+	{"form_feed",2330,0,0,0,0,false},
+	{"code_page",2137,2037,1,0,0,true},
+	{"line_state",2093,2092,1,3,0,true},
+	{"set_text",2181,0,0,0,7,false},
+	{"replace_sel",2170,0,0,0,7,false},
+	{"indic_outline_alpha",2559,2558,1,3,0,true},
+	{"set_x_caret_policy",2402,0,0,1,1,false},
+	{"highlight_guide",2135,2134,3,0,0,true},
+	{"set_whitespace_fore",2084,0,0,5,4,false},
+	{"annotation_visible",2549,2548,1,0,0,true},
+	{"style_clear_all",2050,0,0,0,0,false},
+	{"undo_actions",2790,0,1,0,0,true},
+	{"clear_tab_stops",2675,0,0,3,0,false},
+	{"position_before",2417,0,3,3,0,false},
+	{"scroll_to_end",2629,0,0,0,0,false},
+	{"font_quality",2612,2611,1,0,0,true},
+	{"ensure_visible_enforce_policy",2234,0,0,3,0,false},
+	{"control_char_symbol",2389,2388,1,0,0,true},
+	{"name_of_style",4030,0,0,3,8,false},
+	{"line_indentation",2127,2126,1,3,0,true},
+	{"indic_stroke_width",2752,2751,1,3,0,true},
+	{"line_end_types_allowed",2657,2656,1,0,0,true},
+	{"line_reverse",2354,0,0,0,0,false},
+	{"use_tabs",2125,2124,5,0,0,true},
+	{"eol_annotation_visible",2746,2745,1,0,0,true},
+	{"vc_home_extend",2332,0,0,0,0,false},
+	{"char_left",2304,0,0,0,0,false},
+	{"undo",2176,0,0,0,0,false},
+	{"auto_c_show",2100,0,0,1,7,false},
+	{"line_end_types_active",2658,0,1,0,0,true},
+	{"set_hotspot_active_back",2411,0,0,5,4,false},
+	{"representation_appearance",2767,2766,1,7,0,true},
+	{"selection_end",2145,2144,3,0,0,true},
+	{"para_down_extend",2414,0,0,0,0,false},
+	{"cursor",2387,2386,1,0,0,true},
+	{"modify",2159,0,5,0,0,true},
+	{"set_chars_default",2444,0,0,0,0,false},
+	{"marker_fore",0,2041,4,3,0,true},
+	{"margin_sensitive_n",2247,2246,5,3,0,true},
+	{"find_indicator_show",2640,0,0,3,3,false},
+	{"marker_line_from_handle",2017,0,3,1,0,false},
+	{"target_end_virtual_space",2731,2730,1,0,0,true},
+	{"change_history",2781,2780,1,0,0,true},
+	{"para_down",2413,0,0,0,0,false},
+	{"auto_c_multi",2637,2636,1,0,0,true},
+	{"home_display_extend",2346,0,0,0,0,false},
+	{"char_left_rect_extend",2428,0,0,0,0,false},
+	{"marker_back_translucent",0,2295,4,3,0,true},
+	{"add_styled_text",2002,0,0,2,9,false},
+	{"indicator_value",2503,2502,1,0,0,true},
+	{"char_right",2306,0,0,0,0,false},
+	{"indentation_guides",2133,2132,1,0,0,true},
+	{"can_paste",2173,0,5,0,0,false},
+	{"call_tip_show",2200,0,0,3,7,false},
+	{"marker_delete_handle",2018,0,0,1,0,false},
+	{"style_index_at",2038,0,1,3,0,true},
+	{"whitespace_chars",2647,2443,8,0,0,true},
+	{"property_expanded",4009,0,8,7,0,true},
+	{"move_selected_lines_up",2620,0,0,0,0,false},
+	{"find_text_full",2196,0,3,1,13,false},
+	{"auto_c_order",2661,2660,1,0,0,true},
+	{"auto_c_type_separator",2285,2286,1,0,0,true},
+	{"edge_mode",2362,2363,1,0,0,true},
+	{"copy_separator",2812,2811,8,0,0,true},
+	{"paste",2179,0,0,0,0,false},
+	{"tab_width",2121,2036,1,0,0,true},
+	{"set_styling_ex",2073,0,0,2,7,false},
+	{"focus",2381,2380,5,0,0,true},
+	{"lines_split",2289,0,0,1,0,false},
+	{"create_loader",2632,0,1,3,1,false},
+	{"style_size_fractional",2062,2061,1,3,0,true},
+	{"line_cut",2337,0,0,0,0,false},
+	{"multi_edge_clear_all",2695,0,0,0,0,false},
+	{"fold_all",2662,0,0,1,0,false},
+	{"property_names",4014,0,0,0,8,false},
+	{"indicator_fill_range",2504,0,0,3,2,false},
+	{"document_end_extend",2319,0,0,0,0,false},
+	{"index_position_from_line",2714,0,3,3,1,false},
+	{"line_visible",2228,0,5,3,0,true},
+	{"line_end_display_extend",2348,0,0,0,0,false},
+	{"hotspot_single_line",2497,2421,5,0,0,true},
+	{"get_line_sel_end_position",2425,0,3,3,0,false},
+	{"caret_line_highlight_sub_line",2773,2774,5,0,0,true},
+	{"count_characters",2633,0,1,3,3,false},
+	{"wrap_visual_flags",2461,2460,1,0,0,true},
+	{"register_rgba_image",2627,0,0,1,7,false},
+	{"add_ref_document",2376,0,0,0,1,false},
+	{"line_from_index_position",2713,0,3,3,1,false},
+	{"add_selection",2573,0,0,3,3,false},
+	{"set_default_fold_display_text",2722,0,0,0,7,false},
+	{"page_up_rect_extend",2433,0,0,0,0,false},
+	{"vc_home_display_extend",2653,0,0,0,0,false},
+	{"print_magnification",2147,2146,1,0,0,true},
+	{"eol_annotation_clear_all",2744,0,0,0,0,false},
+	{"caret_line_layer",2764,2765,1,0,0,true},
+	{"auto_c_max_height",2211,2210,1,0,0,true},
+	{"word_end_position",2267,0,3,3,5,false},
+	{"anchor",2009,2026,3,0,0,true},
+	{"mod_event_mask",2378,2359,1,0,0,true},
+	{"position_cache",2515,2514,1,0,0,true},
+	{"auto_c_auto_hide",2119,2118,5,0,0,true},
+	{"character_category_optimization",2721,2720,1,0,0,true},
+	{"line_from_position",2166,0,3,3,0,false},
+	{"distance_to_secondary_styles",4025,0,1,0,0,true},
+	{"sel_eol_filled",2479,2480,5,0,0,true},
+	{"get_cur_line",2027,0,3,2,8,false},
+	{"indicator_clear_range",2505,0,0,3,2,false},
+	{"clear_all_cmd_keys",2072,0,0,0,0,false},
+	{"line_count",2154,0,1,0,0,true},
+	{"set_hotspot_active_fore",2410,0,0,5,4,false},
+	{"annotation_clear_all",2547,0,0,0,0,false},
+	{"search_in_target",2197,0,3,2,7,false},
+	{"fold_children",2238,0,0,3,1,false},
+	{"paste_convert_endings",2468,2467,5,0,0,true},
+	{"marker_delete_all",2045,0,0,3,0,false},
+	{"property_int",4010,0,1,7,0,true},
+	{"undo_sequence",2799,0,1,0,0,true},
+	{"fold_level",2223,2222,1,3,0,true},
+	{"marker_back",0,2042,4,3,0,true},
+	{"get_hotspot_active_fore",2494,0,4,0,0,false},
+	{"push_undo_action_type",2800,0,0,1,3,false},
+	{"lexer_language",4012,0,8,0,0,true},
+	{"ensure_visible",2232,0,0,3,0,false},
+	{"caret_width",2189,2188,1,0,0,true},
+	{"change_last_undo_action_text",2801,0,0,2,7,false},
+	{"marker_number_from_line",2733,0,3,3,3,false},
+	{"undo_tentative",2796,2795,1,0,0,true},
+	{"direct_pointer",2185,0,1,0,0,true},
+	{"position_after",2418,0,3,3,0,false},
+	{"scroll_to_start",2628,0,0,0,0,false},
+	{"scroll_width_tracking",2517,2516,5,0,0,true},
+	{"doc_pointer",2357,2358,1,0,0,true},
+	{"word_part_left_extend",2391,0,0,0,0,false},
+	{"margin_cursor_n",2249,2248,1,3,0,true},
+	{"range_pointer",2643,0,1,3,0,true},
+	{"additional_sel_fore",0,2600,4,0,0,true},
+	{"additional_sel_alpha",2603,2602,1,0,0,true},
+	{"line_dedent",2814,0,0,0,0,false},
+	{"end_at_last_line",2278,2277,5,0,0,true},
+	{"target_from_selection",2287,0,0,0,0,false},
+	{"word_right",2310,0,0,0,0,false},
+	{"choose_caret_x",2399,0,0,0,0,false},
+	{"user_list_show",2117,0,0,1,7,false},
+	{"copy_text",2420,0,0,2,7,false},
+	{"clear_registered_images",2408,0,0,0,0,false},
+	{"brace_highlight_indicator",2498,0,0,5,3,false},
+	{"multi_paste",2615,2614,1,0,0,true},
+	{"assign_cmd_key",2070,0,0,6,1,false},
+	{"line_down",2300,0,0,0,0,false},
+	{"caret_style",2513,2512,1,0,0,true},
+	{"register_image",2405,0,0,1,7,false},
+	{"word_right_end_extend",2442,0,0,0,0,false},
+	{"property",4008,4004,8,7,0,true},
+	{"hide_selection",2163,0,0,5,0,false},
+	{"position_from_point",2022,0,3,1,1,false},
+	{"vertical_center_caret",2619,0,0,0,0,false},
+	{"get_hotspot_active_back",2495,0,4,0,0,false},
+	{"punctuation_chars",2649,2648,8,0,0,true},
+	{"search_flags",2199,2198,1,0,0,true},
+	{"stuttered_page_up",2435,0,0,0,0,false},
+	{"set_sel_back",2068,0,0,5,4,false},
+	{"edit_toggle_overtype",2324,0,0,0,0,false},
+	{"can_undo",2174,0,5,0,0,false},
+	{"caret_line_back_alpha",2471,2470,1,0,0,true},
+	{"auto_c_max_width",2209,2208,1,0,0,true},
+	{"rectangular_selection_modifier",2599,2598,1,0,0,true},
+	{"word_left_end",2439,0,0,0,0,false},
+	{"clear_all",2004,0,0,0,0,false},
+	{"zoom",2374,2373,1,0,0,true},
+	{"replace_target_minimal",2779,0,3,2,7,false},
+	{"call_tip_active",2202,0,5,0,0,false},
+	{"del_line_left",2395,0,0,0,0,false},
+	{"line_down_rect_extend",2426,0,0,0,0,false},
+	{"text_width",2276,0,1,3,7,false},
+	{"add_text",2001,0,0,2,7,false},
+	{"cancel",2325,0,0,0,0,false},
+	{"swap_main_anchor_caret",2607,0,0,0,0,false},
+	{"overtype",2187,2186,5,0,0,true},
+	{"line_end_wrap",2451,0,0,0,0,false},
+	{"call_tip_fore",0,2206,4,0,0,true},
+	{"count_code_units",2715,0,1,3,3,false},
+	{"set_length_for_encode",2448,0,0,3,0,false},
+	{"use_pop_up",2371,0,0,1,0,false},
+	{"all_lines_visible",2236,0,5,0,0,true},
+	{"position_from_point_close",2023,0,3,1,1,false},
+	{"annotation_lines",2546,0,1,3,0,true},
+	{"clear_document_style",2005,0,0,0,0,false},
+	{"rotate_selection",2606,0,0,0,0,false},
+	{"private_lexer_call",4013,0,1,1,1,false},
+	{"line_up",2302,0,0,0,0,false},
+	{"undo_action_position",2803,0,3,1,0,true},
+	{"set_fold_margin_hi_color",2291,0,0,5,4,false},
+	{"document_options",2379,0,1,0,0,true},
+	{"del_line_right",2396,0,0,0,0,false},
+	{"vc_home_wrap_extend",2454,0,0,0,0,false},
+	{"selection_n_caret_virtual_space",2581,2580,1,3,0,true},
+	{"undo_action_type",2802,0,1,1,0,true},
+	{"h_scroll_bar",2131,2130,5,0,0,true},
+	{"set_whitespace_back",2085,0,0,5,4,false},
+	{"get_next_tab_stop",2677,0,1,3,1,false},
+	{"wrap_visual_flags_location",2463,2462,1,0,0,true},
+	{"additional_carets_blink",2568,2567,5,0,0,true},
+	{"get_default_fold_display_text",2723,0,0,0,8,false},
+	{"char_at",2007,0,1,3,0,true},
+	{"allocate_lines",0,2089,3,0,0,true},
+	{"call_tip_fore_hlt",0,2207,4,0,0,true},
+	{"caret_line_back",2097,2098,4,0,0,true},
+	{"scroll_width",2275,2274,1,0,0,true},
+	{"style_bold",2483,2053,5,3,0,true},
+	{"brace_highlight",2351,0,0,3,3,false},
+	{"move_extends_selection",2706,2719,5,0,0,true},
+	{"key_words",0,4005,7,1,0,true},
+	{"cut_allow_line",2810,0,0,0,0,false},
+	{"i_lexer",0,4033,1,0,0,true},
+	{"line_end",2314,0,0,0,0,false},
+	{"undo_current",2798,2797,1,0,0,true},
+	{"word_start_position",2266,0,3,3,5,false},
+	{"indic_fore",2083,2082,4,3,0,true},
+	{"multiple_selection",2564,2563,5,0,0,true},
+	{"style_eol_filled",2487,2057,5,3,0,true},
+	{"rgba_image_height",0,2625,1,0,0,true},
+	{"element_base_color",2758,0,4,1,0,true},
+	{"scroll_caret",2169,0,0,0,0,false},
+	{"mouse_down_captures",2385,2384,5,0,0,true},
+	{"selection_n_end",2587,2586,3,3,0,true},
+	{"word_right_extend",2311,0,0,0,0,false},
+	{"marker_fore_translucent",0,2294,4,3,0,true},
+	{"eol_annotation_style_offset",2748,2747,3,0,0,true},
+	{"position_relative_code_units",2716,0,3,3,3,false},
+	{"get_text",2182,0,0,2,8,false},
+	{"target_as_utf8",2447,0,0,0,8,false},
+	{"additional_caret_fore",2605,2604,4,0,0,true},
+	{"contracted_fold_next",2618,0,3,3,0,false},
+	{"undo_collection",2019,2012,5,0,0,true},
+	{"caret_line_frame",2704,2705,1,0,0,true},
+	{"para_up",2415,0,0,0,0,false},
+	{"home_wrap",2349,0,0,0,0,false},
+	{"annotation_styles",2545,2544,8,3,0,true},
+	{"tab_minimum_width",2725,2724,1,0,0,true},
+	{"marker_define_pixmap",2049,0,0,3,7,false},
+	{"page_down_rect_extend",2434,0,0,0,0,false},
+	{"wrap_count",2235,0,1,3,0,false},
+	{"marker_get",2046,0,1,3,0,false},
+	{"allocate_extended_styles",2553,0,1,1,0,false},
+	{"format_range",2151,0,3,5,14,false},
+	{"visible_from_doc_line",2220,0,3,3,0,false},
+	{"document_end",2318,0,0,0,0,false},
+	{"additional_sel_back",0,2601,4,0,0,true},
+	{"named_styles",4029,0,1,0,0,true},
+	{"line_character_index",2710,0,1,0,0,true},
+	{"find_column",2456,0,3,3,3,false},
+	{"auto_c_select",2108,0,0,0,7,false},
+	{"eol_mode",2030,2031,1,0,0,true},
+	{"replace_target",2194,0,1,2,7,false},
+	{"page_down_extend",2323,0,0,0,0,false},
+	{"description_of_style",4032,0,0,3,8,false},
+	{"multi_edge_add_line",2694,0,0,1,4,false},
+	{"phases_draw",2673,2674,1,0,0,true},
+	{"caret_line_visible",2095,2096,5,0,0,true},
+	{"style_case",2489,2060,1,3,0,true},
+	{"back_tab",2328,0,0,0,0,false},
+	{"line_end_position",2136,0,3,3,0,true},
+	{"marker_alpha",0,2476,1,3,0,true},
+	{"line_up_extend",2303,0,0,0,0,false},
+	{"multiple_select_add_each",2689,0,0,0,0,false},
+	{"marker_previous",2048,0,3,3,1,false},
+	{"call_tip_pos_start",0,2214,3,0,0,true},
+	{"home_rect_extend",2430,0,0,0,0,false},
+	{"layout_threads",2776,2775,1,0,0,true},
+	{"empty_undo_buffer",2175,0,0,0,0,false},
+	{"redo",2011,0,0,0,0,false},
+	{"character_pointer",2520,0,1,0,0,true},
+	{"indic_under",2511,2510,5,3,0,true},
+	{"style_fore",2481,2051,4,3,0,true},
+	{"auto_c_ignore_case",2116,2115,5,0,0,true},
+	{"annotation_style",2543,2542,3,3,0,true},
+	{"auto_c_pos_start",2103,0,3,0,0,false},
+	{"fold_flags",0,2233,1,0,0,true},
+	{"marker_next",2047,0,3,3,1,false},
+	{"accessibility",2703,2702,1,0,0,true},
+	{"find_indicator_hide",2642,0,0,0,0,false},
+	{"property_type",4015,0,1,7,0,false},
+	{"auto_c_options",2639,2638,1,0,0,true},
+	{"move_caret_inside_view",2401,0,0,0,0,false},
+	{"stuttered_page_up_extend",2436,0,0,0,0,false},
+	{"describe_key_word_sets",4017,0,0,0,8,false},
+	{"identifier",2623,2622,1,0,0,true},
+	{"column",2129,0,3,3,0,true},
+	{"eol_annotation_style",2743,2742,3,3,0,true},
+	{"selection_empty",2650,0,5,0,0,true},
+	{"auto_c_current_text",2610,0,8,0,0,true},
+	{"page_up",2320,0,0,0,0,false},
+	{"tab_draw_mode",2698,2699,1,0,0,true},
+	{"lines_join",2288,0,0,0,0,false},
+	{"line_end_rect_extend",2432,0,0,0,0,false},
+	{"line_end_wrap_extend",2452,0,0,0,0,false},
+	{"text_length",2183,0,1,0,0,true},
+	{"brace_bad_light_indicator",2499,0,0,5,3,false},
+	{"point_y_from_position",2165,0,1,0,3,false},
+	{"annotation_style_offset",2551,2550,3,0,0,true},
+	{"indicator_all_on_for",2506,0,1,3,0,false},
+	{"margin_width_n",2243,2242,1,3,0,true},
+	{"begin_undo_action",2078,0,0,0,0,false},
+	{"target_whole_document",2690,0,0,0,0,false},
+	{"line_scroll_up",2343,0,0,0,0,false},
+	{"point_x_from_position",2164,0,1,0,3,false},
+	{"indic_hover_style",2681,2680,1,3,0,true},
+	{"search_prev",2368,0,3,1,7,false},
+	{"toggle_fold_show_text",2700,0,0,3,7,false},
+	{"replace_target_re",2195,0,1,2,7,false},
+	{"view_eol",2355,2356,5,0,0,true},
+	{"char_position_from_point_close",2562,0,3,1,1,false},
+	{"max_line_state",2094,0,1,0,0,true},
+	{"auto_c_cancel",2101,0,0,0,0,false},
+	{"end_styled",2028,0,3,0,0,true},
+	{"clear_representation",2667,0,0,7,0,false},
+	{"print_color_mode",2149,2148,1,0,0,true},
+	{"delete_back_not_line",2344,0,0,0,0,false},
+	{"target_text",2687,0,8,0,0,true},
+	{"direct_function",2184,0,1,0,0,true},
+	{"auto_c_cancel_at_start",2111,2110,5,0,0,true},
+	{"delete_back",2326,0,0,0,0,false},
+	{"tab",2327,0,0,0,0,false},
+	{"status",2383,2382,1,0,0,true},
+	{"grab_focus",2400,0,0,0,0,false},
+	{"change_insertion",2672,0,0,2,7,false},
+	{"stuttered_page_down_extend",2438,0,0,0,0,false},
+	{"margin_text_clear_all",2536,0,0,0,0,false},
+	{"identifiers",0,4024,7,3,0,true},
+	{"release_document",2377,0,0,0,1,false},
+	{"automatic_fold",2664,2663,1,0,0,true},
+	{"brace_match_next",2369,0,3,3,3,false},
+	{"selection_n_start",2585,2584,3,3,0,true},
+	{"document_start_extend",2317,0,0,0,0,false},
+	{"release_line_character_index",2712,0,0,1,0,false},
+	{"line_scroll",2168,0,0,1,1,false},
+	{"text_height",2279,0,1,3,0,false},
+	{"sub_styles_start",4021,0,1,1,0,true},
+	{"tab_indents",2261,2260,5,0,0,true},
+	{"auto_c_case_insensitive_behavior",2635,2634,1,0,0,true},
+	{"set_sel_fore",2067,0,0,5,4,false},
+	{"hotspot_active_underline",2496,2412,5,0,0,true},
+	{"caret_line_visible_always",2654,2655,5,0,0,true},
+	{"style_visible",2491,2074,5,3,0,true},
+	{"line_down_extend",2301,0,0,0,0,false},
+	{"word_right_end",2441,0,0,0,0,false},
+	{"ime_interaction",2678,2679,1,0,0,true},
+	{"add_tab_stop",2676,0,0,3,1,false},
+	{"line_indent",2813,0,0,0,0,false},
+	{"call_tip_use_style",0,2212,1,0,0,true},
+	{"clear_selections",2571,0,0,0,0,false},
+	{"selection_start",2143,2142,3,0,0,true},
+	{"additional_carets_visible",2609,2608,5,0,0,true},
+	{"insert_text",2003,0,0,3,7,false},
+	{"call_tip_back",0,2205,4,0,0,true},
+	{"selection_n_end_virtual_space",2727,0,1,3,0,true},
+	{"call_tip_cancel",2201,0,0,0,0,false},
+	{"toggle_caret_sticky",2459,0,0,0,0,false},
+	{"start_styling",2032,0,0,3,1,false},
+	{"start_record",3001,0,0,0,0,false},
+	{"zoom_in",2333,0,0,0,0,false},
+	{"hide_lines",2227,0,0,3,3,false},
+	{"marker_add_set",2466,0,0,3,1,false},
+	{"rectangular_selection_anchor",2591,2590,3,0,0,true},
+	{"encoded_from_utf8",2449,0,0,7,8,false},
+	{"target_start",2191,2190,3,0,0,true},
+	{"command_events",2718,2717,5,0,0,true},
+	{"style_weight",2064,2063,1,3,0,true},
+	{"vc_home_rect_extend",2431,0,0,0,0,false},
+	{"word_chars",2646,2077,8,0,0,true},
+	{"move_selected_lines_down",2621,0,0,0,0,false},
+	{"eol_annotation_text",2741,2740,8,3,0,true},
+	{"read_only",2140,2171,5,0,0,true},
+	{"marker_back_selected_translucent",0,2296,4,3,0,true},
+	{"marker_symbol_defined",2529,0,1,3,0,false},
+	{"fold_expanded",2230,2229,5,3,0,true},
+	{"change_selection_mode",2659,0,0,1,0,false},
+	{"style_stretch",2259,2258,1,3,0,true},
+	{"position_relative",2670,0,3,3,1,false},
+	{"view_ws",2020,2021,1,0,0,true},
+	{"element_is_set",2756,0,5,1,0,true},
+	{"is_range_word",2691,0,5,3,3,false},
+	{"last_child",2224,0,3,3,0,true},
+	{"null",2172,0,0,0,0,false},
+	{"marker_define_rgba_image",2626,0,0,3,7,false},
+	{"find_text",2150,0,3,1,12,false},
+	{"edge_column",2360,2361,1,0,0,true},
+	{"marker_add",2043,0,1,3,3,false},
+	{"set_fold_margin_color",2290,0,0,5,4,false},
+	{"del_word_left",2335,0,0,0,0,false},
+	{"style_font",2486,2056,8,3,0,true},
+	{"rgba_image_width",0,2624,1,0,0,true},
+	{"get_text_range_full",2039,0,3,0,11,false},
+	{"primary_style_from_style",4028,0,1,3,0,true},
+	{"style_underline",2488,2059,5,3,0,true},
+	{"lower_case",2340,0,0,0,0,false},
+	{"clear_all_representations",2770,0,0,0,0,false},
+	{"format_range_full",2777,0,3,5,15,false},
+	{"get_line_sel_start_position",2424,0,3,3,0,false},
+	{"auto_c_complete",2104,0,0,0,0,false},
+	{"end_undo_action",2079,0,0,0,0,false},
+	{"mouse_dwell_time",2265,2264,1,0,0,true},
+	{"indic_alpha",2524,2523,1,3,0,true},
+	{"home_extend",2313,0,0,0,0,false},
+	{"copy",2178,0,0,0,0,false},
+	{"buffered_draw",2034,2035,5,0,0,true},
+	{"caret_sticky",2457,2458,1,0,0,true},
+	{"auto_c_choose_single",2114,2113,5,0,0,true},
+	{"call_tip_set_hlt",2204,0,0,3,3,false},
+	{"rgba_image_scale",0,2651,1,0,0,true},
+	{"selections",2570,0,1,0,0,true},
+	{"free_sub_styles",4023,0,0,0,0,false},
+	{"style_at",2010,0,3,3,0,true},
+	{"call_tip_position",0,2213,5,0,0,true},
+	{"margin_right",2158,2157,1,0,0,true},
+	{"target_start_virtual_space",2729,2728,1,0,0,true},
+	{"word_left_extend",2309,0,0,0,0,false},
+	{"vc_home",2331,0,0,0,0,false},
+	{"word_left_end_extend",2440,0,0,0,0,false},
+	{"doc_line_from_visible",2221,0,3,3,0,false},
+	{"selection_n_caret",2577,2576,3,3,0,true},
+	{"representation_color",2769,2768,4,7,0,true},
+	{"search_anchor",2366,0,0,0,0,false},
+	{"lines_on_screen",2370,0,1,0,0,true},
+	{"release_all_extended_styles",2552,0,0,0,0,false},
+	{"style_check_monospaced",2255,2254,5,3,0,true},
+	{"convert_eols",2029,0,0,1,0,false},
+	{"show_lines",2226,0,0,3,3,false},
+	{"home_wrap_extend",2450,0,0,0,0,false},
+	{"vc_home_wrap",2453,0,0,0,0,false},
+	{"upper_case",2341,0,0,0,0,false},
+	{"rectangular_selection_anchor_virtual_space",2595,2594,1,0,0,true},
+	{"caret_period",2075,2076,1,0,0,true},
+	{"cut",2177,0,0,0,0,false},
+	{"reset_element_color",2755,0,0,1,0,false},
+	{"stop_record",3002,0,0,0,0,false},
+	{"word_part_right",2392,0,0,0,0,false},
+	{"style_size",2485,2055,1,3,0,true},
+	{"selection_n_start_virtual_space",2726,0,1,3,0,true},
+	{"selection_layer",2762,2763,1,0,0,true},
+	{"extra_descent",2528,2527,1,0,0,true},
+	{"selection_from_point",2474,0,1,1,1,false},
+	{"whitespace_size",2087,2086,1,0,0,true},
+	{"get_sel_text",2161,0,0,0,8,false},
+	{"append_text",2282,0,0,2,7,false},
+	{"expand_children",2239,0,0,3,1,false},
+	{"page_up_extend",2321,0,0,0,0,false},
+	{"char_position_from_point",2561,0,3,1,1,false},
+	{"line_scroll_down",2342,0,0,0,0,false},
+	{"first_visible_line",2152,2613,3,0,0,true},
+	{"element_allows_translucent",2757,0,5,1,0,true},
+	{"create_document",2375,0,1,3,1,false},
+	{"auto_c_current",2445,0,3,0,0,true},
+	{"marker_handle_from_line",2732,0,1,3,3,false},
+	{"gap_position",2644,0,3,0,0,true},
+	{"rectangular_selection_caret_virtual_space",2593,2592,1,0,0,true},
+	{"margin_mask_n",2245,2244,1,3,0,true},
+	{"margin_style",2533,2532,3,3,0,true},
+	{"v_scroll_bar",2281,2280,5,0,0,true},
+	{"multi_edge_column",2749,0,1,3,0,true},
+	{"clear",2180,0,0,0,0,false},
+	{"selection_n_anchor",2579,2578,3,3,0,true},
+	{"style_invisible_representation",2257,2256,8,3,0,true},
+	{"margin_text",2531,2530,8,3,0,true},
+	{"zoom_out",2334,0,0,0,0,false},
+};
+
+// Returns the 32-bit FNV-1a hash of the given name, using the given seed.
+static uint32_t iface_hash(const char *name, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (const unsigned char *p = (const unsigned char *)name; *p; p++) h = (h ^ *p) * 16777619u;
+	return h;
+}
+
+// Returns the interface entry for the given Scintilla function or property name, or NULL if
+// there is none.
+static const IfaceEntry *find_iface(const char *name) {
+	int d = iface_displacements[iface_hash(name, 0) % IFACE_BUCKETS];
+	const IfaceEntry *entry = &iface_entries[iface_hash(name, d) % IFACE_SIZE];
+	return strcmp(entry->name, name) == 0 ? entry : NULL;
+}
+
+// Scintilla notification fields passed to event handlers.
+enum { NOTIFY_NONE, NOTIFY_ANNOTATION_LINES_ADDED, NOTIFY_CH, NOTIFY_CHARACTER_SOURCE, NOTIFY_FOLD_LEVEL_NOW, NOTIFY_FOLD_LEVEL_PREV, NOTIFY_L_PARAM, NOTIFY_LENGTH, NOTIFY_LINE, NOTIFY_LINES_ADDED, NOTIFY_LIST_COMPLETION_METHOD, NOTIFY_LIST_TYPE, NOTIFY_MARGIN, NOTIFY_MESSAGE, NOTIFY_MODIFICATION_TYPE, NOTIFY_MODIFIERS, NOTIFY_POSITION, NOTIFY_TEXT, NOTIFY_TOKEN, NOTIFY_UPDATED, NOTIFY_W_PARAM, NOTIFY_X, NOTIFY_Y };
+
+// A Scintilla notification's event name and the notification fields passed to its handlers,
+// in order.
+typedef struct {
+	const char *name;
+	int fields[11]; // terminated by NOTIFY_NONE
+} IfaceEvent;
+
+#define IFACE_EVENT_BASE 2000
+#define IFACE_EVENT_COUNT 33
+
+// Indexed by notification code minus IFACE_EVENT_BASE.
+static const IfaceEvent iface_events[IFACE_EVENT_COUNT] = {
+	[0] = {"style_needed", {NOTIFY_POSITION}},
+	[1] = {"char_added", {NOTIFY_CH, NOTIFY_CHARACTER_SOURCE}},
+	[2] = {"save_point_reached", {NOTIFY_NONE}},
+	[3] = {"save_point_left", {NOTIFY_NONE}},
+	[4] = {"modify_attempt_ro", {NOTIFY_NONE}},
+	[5] = {"key", {NOTIFY_CH, NOTIFY_MODIFIERS}},
+	[6] = {"double_click", {NOTIFY_POSITION, NOTIFY_LINE, NOTIFY_MODIFIERS}},
+	[7] = {"update_ui", {NOTIFY_UPDATED}},
+	[8] = {"modified", {NOTIFY_POSITION, NOTIFY_MODIFICATION_TYPE, NOTIFY_TEXT, NOTIFY_LENGTH, NOTIFY_LINES_ADDED, NOTIFY_LINE, NOTIFY_FOLD_LEVEL_NOW, NOTIFY_FOLD_LEVEL_PREV, NOTIFY_TOKEN, NOTIFY_ANNOTATION_LINES_ADDED}},
+	[9] = {"macro_record", {NOTIFY_MESSAGE, NOTIFY_W_PARAM, NOTIFY_L_PARAM}},
+	[10] = {"margin_click", {NOTIFY_MARGIN, NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[11] = {"need_shown", {NOTIFY_POSITION, NOTIFY_LENGTH}},
+	[13] = {"painted", {NOTIFY_NONE}},
+	[14] = {"user_list_selection", {NOTIFY_LIST_TYPE, NOTIFY_TEXT, NOTIFY_POSITION, NOTIFY_CH, NOTIFY_LIST_COMPLETION_METHOD}},
+	[15] = {"uri_dropped", {NOTIFY_TEXT}},
+	[16] = {"dwell_start", {NOTIFY_POSITION, NOTIFY_X, NOTIFY_Y}},
+	[17] = {"dwell_end", {NOTIFY_POSITION, NOTIFY_X, NOTIFY_Y}},
+	[18] = {"zoom", {NOTIFY_NONE}},
+	[19] = {"hot_spot_click", {NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[20] = {"hot_spot_double_click", {NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[21] = {"call_tip_click", {NOTIFY_POSITION}},
+	[22] = {"auto_c_selection", {NOTIFY_TEXT, NOTIFY_POSITION, NOTIFY_CH, NOTIFY_LIST_COMPLETION_METHOD}},
+	[23] = {"indicator_click", {NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[24] = {"indicator_release", {NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[25] = {"auto_c_canceled", {NOTIFY_NONE}},
+	[26] = {"auto_c_char_deleted", {NOTIFY_NONE}},
+	[27] = {"hot_spot_release_click", {NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[28] = {"focus_in", {NOTIFY_NONE}},
+	[29] = {"focus_out", {NOTIFY_NONE}},
+	[30] = {"auto_c_completed", {NOTIFY_TEXT, NOTIFY_POSITION, NOTIFY_CH, NOTIFY_LIST_COMPLETION_METHOD}},
+	[31] = {"margin_right_click", {NOTIFY_MARGIN, NOTIFY_POSITION, NOTIFY_MODIFIERS}},
+	[32] = {"auto_c_selection_change", {NOTIFY_LIST_TYPE, NOTIFY_TEXT, NOTIFY_POSITION}},
+};
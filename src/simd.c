@@ -0,0 +1,166 @@
+// Copyright 2007-2024 Mitchell. See LICENSE.
+
+#include "simd.h"
+
+#include <string.h>
+#if defined(__x86_64__) || defined(_M_X64)
+#define HAVE_SSE2 1 // SSE2 is part of the x86-64 baseline
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define HAVE_AVX2 1 // compiled per-function and dispatched at runtime
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h> // for _BitScanForward
+#endif
+#endif
+
+#if HAVE_AVX2
+// Returns whether or not the CPU supports AVX2 instructions.
+static bool has_avx2(void) {
+	static int avx2 = -1;
+	if (avx2 < 0) avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+	return avx2;
+}
+#endif
+
+#if HAVE_SSE2
+// Returns the index of the lowest set bit in the given non-zero mask.
+static int lowest_bit(unsigned int mask) {
+#if defined(_MSC_VER)
+	unsigned long i;
+	return (_BitScanForward(&i, mask), (int)i);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// Returns the number of set bits in the given mask.
+static int count_bits(unsigned int mask) {
+#if defined(__GNUC__)
+	return __builtin_popcount(mask);
+#else
+	mask = mask - ((mask >> 1) & 0x55555555), mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+	return (((mask + (mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+#endif
+
+// Returns the length of the longest prefix of the given text that is ASCII.
+static size_t ascii_prefix_scalar(const unsigned char *s, size_t len) {
+	size_t i = 0;
+	while (i < len && s[i] < 0x80) i++;
+	return i;
+}
+
+#if HAVE_SSE2
+// SSE2 version of `ascii_prefix_scalar()` that checks 16 bytes at a time.
+static size_t ascii_prefix_sse2(const unsigned char *s, size_t len) {
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+		if (mask) return i + lowest_bit(mask);
+	}
+	return i + ascii_prefix_scalar(s + i, len - i);
+}
+#endif
+
+#if HAVE_AVX2
+// AVX2 version of `ascii_prefix_scalar()` that checks 32 bytes at a time.
+__attribute__((target("avx2"))) static size_t ascii_prefix_avx2(
+	const unsigned char *s, size_t len) {
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		unsigned int mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(s + i)));
+		if (mask) return i + lowest_bit(mask);
+	}
+	return i + ascii_prefix_sse2(s + i, len - i);
+}
+#endif
+
+// Returns the length of the longest prefix of the given text that is ASCII, using the most
+// capable instruction set available.
+static size_t ascii_prefix(const unsigned char *s, size_t len) {
+#if HAVE_AVX2
+	if (has_avx2()) return ascii_prefix_avx2(s, len);
+#endif
+#if HAVE_SSE2
+	return ascii_prefix_sse2(s, len);
+#else
+	return ascii_prefix_scalar(s, len);
+#endif
+}
+
+ptrdiff_t utf8_prefix(const char *text, size_t len) {
+	const unsigned char *s = (const unsigned char *)text;
+	size_t i = 0;
+	// Skip runs of ASCII with vector instructions and validate multi-byte characters one by one.
+	while (i < len) {
+		unsigned char c = s[i];
+		if (c < 0x80) {
+			i += ascii_prefix(s + i, len - i);
+			continue;
+		}
+		// Determine the number of continuation bytes and the range of the first one, which
+		// excludes overlong encodings, surrogates, and code points above U+10FFFF.
+		int n = c >= 0xC2 && c <= 0xDF ? 1 : (c & 0xF0) == 0xE0 ? 2 : c >= 0xF0 && c <= 0xF4 ? 3 : 0;
+		if (n == 0) return -1;
+		unsigned char lo = c == 0xE0 ? 0xA0 : c == 0xF0 ? 0x90 : 0x80,
+									hi = c == 0xED ? 0x9F : c == 0xF4 ? 0x8F : 0xBF;
+		for (int j = 1; j <= n; j++, lo = 0x80, hi = 0xBF) {
+			if (i + j >= len) return i; // incomplete character
+			if (s[i + j] < lo || s[i + j] > hi) return -1;
+		}
+		i += n + 1;
+	}
+	return i;
+}
+
+bool utf8_valid(const char *s, size_t len) { return utf8_prefix(s, len) == (ptrdiff_t)len; }
+
+// Returns the number of bytes in the given text that are not UTF-8 continuation bytes.
+static size_t utf8_count_scalar(const unsigned char *s, size_t len) {
+	size_t count = 0;
+	for (size_t i = 0; i < len; i++) count += (s[i] & 0xC0) != 0x80;
+	return count;
+}
+
+#if HAVE_SSE2
+// SSE2 version of `utf8_count_scalar()` that counts 16 bytes at a time.
+// Continuation bytes are 0x80-0xBF, which are -128 to -65 as signed bytes.
+static size_t utf8_count_sse2(const unsigned char *s, size_t len) {
+	size_t count = 0, i = 0;
+	const __m128i min = _mm_set1_epi8(-65);
+	for (; i + 16 <= len; i += 16)
+		count += count_bits(
+			_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i *)(s + i)), min)));
+	return count + utf8_count_scalar(s + i, len - i);
+}
+#endif
+
+#if HAVE_AVX2
+// AVX2 version of `utf8_count_scalar()` that counts 32 bytes at a time.
+__attribute__((target("avx2"))) static size_t utf8_count_avx2(const unsigned char *s, size_t len) {
+	size_t count = 0, i = 0;
+	const __m256i min = _mm256_set1_epi8(-65);
+	for (; i + 32 <= len; i += 32)
+		count += count_bits(_mm256_movemask_epi8(
+			_mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i *)(s + i)), min)));
+	return count + utf8_count_sse2(s + i, len - i);
+}
+#endif
+
+size_t utf8_count(const char *text, size_t len) {
+	const unsigned char *s = (const unsigned char *)text;
+#if HAVE_AVX2
+	if (has_avx2()) return utf8_count_avx2(s, len);
+#endif
+#if HAVE_SSE2
+	return utf8_count_sse2(s, len);
+#else
+	return utf8_count_scalar(s, len);
+#endif
+}
+
+// C libraries already dispatch memchr() to their own vectorized implementations.
+const char *find_byte(const char *s, size_t len, int c) { return memchr(s, c, len); }
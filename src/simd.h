@@ -0,0 +1,36 @@
+// Copyright 2007-2024 Mitchell. See LICENSE.
+// Vectorized text scanning kernels.
+// On x86-64, kernels use AVX2 or SSE2 instructions depending on what the CPU supports at
+// runtime. Other architectures use scalar code.
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Returns the length of the longest prefix of the given text that consists of complete,
+ * valid UTF-8 characters.
+ * Overlong encodings, surrogates, and code points above U+10FFFF are invalid.
+ * @param s The text to validate.
+ * @param len The length of the text.
+ * @return prefix length, or -1 if the text is invalid before any trailing incomplete character
+ */
+ptrdiff_t utf8_prefix(const char *s, size_t len);
+
+/** Returns whether or not the given text is entirely valid UTF-8.
+ * @param s The text to validate.
+ * @param len The length of the text.
+ */
+bool utf8_valid(const char *s, size_t len);
+
+/** Returns the number of UTF-8 characters in the given text.
+ * This is the number of bytes that are not continuation bytes. The text is not validated.
+ * @param s The text to count characters in.
+ * @param len The length of the text.
+ */
+size_t utf8_count(const char *s, size_t len);
+
+/** Returns a pointer to the first occurrence of the given byte in the given text, or `NULL`.
+ * @param s The text to search.
+ * @param len The length of the text.
+ * @param c The byte to search for.
+ */
+const char *find_byte(const char *s, size_t len, int c);
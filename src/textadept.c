@@ -1,6 +1,8 @@
 // Copyright 2007-2024 Mitchell. See LICENSE.
 
 #include "textadept.h"
+#include "iface.h"
+#include "simd.h"
 
 // External dependency includes.
 #include "lualib.h" // for luaL_openlibs
@@ -12,17 +14,24 @@
 #include <locale.h>
 #include <iconv.h>
 #include <math.h> // for fmax
+#include <stdint.h> // for int64_t
 #include <stdlib.h>
 #include <string.h>
+#include <time.h> // for timespec_get
 #if __linux__
 #include <unistd.h> // for readlink
 #elif _WIN32
-#include <windows.h> // for GetModuleFileName
+#include <io.h> // for _commit
+#include <windows.h> // for GetModuleFileName, MoveFileExA
 #elif __APPLE__
 #include <mach-o/dyld.h> // for _NSGetExecutablePath
 #elif (__FreeBSD__ || __NetBSD__ || __DragonFly__)
 #include <sys/sysctl.h> // for sysctl
 #endif
+#if !_WIN32
+#include <sys/stat.h> // for stat, fchmod
+#include <unistd.h> // for fsync, fchown
+#endif
 
 // Variables declared in textadept.h.
 char *textadept_home;
@@ -33,19 +42,157 @@ lua_State *lua;
 int exit_status;
 
 static char *os;
-static SciObject *dummy_view; // for working with documents not shown in an existing view
+// Pool of views for working with documents not shown in an existing view, ordered from most
+// recently used to least recently used.
+// Keeping several documents loaded avoids re-attaching them (and discarding their layout
+// caches) when alternately working with more than one of them.
+#define MAX_DUMMY_VIEWS 16
+static SciObject *dummy_views[MAX_DUMMY_VIEWS];
+static int num_dummy_views = 4; // `ui.buffer_views`
+static lua_Integer dummy_view_rebinds; // `ui.buffer_view_rebinds`
 
 // Lua objects.
-static const char *BUFFERS = "ta_buffers", *VIEWS = "ta_views", *ARG = "ta_arg"; // registry tables
+static const char *BUFFERS = "ta_buffers", *VIEWS = "ta_views", *ARG = "ta_arg",
+									*FUNCTIONS = "ta_functions", *PROPERTIES = "ta_properties",
+									*EVENT_IDS = "ta_event_ids", *HANDLERS = "ta_handlers",
+									*EVENT_STATS = "ta_event_stats"; // registry tables
 static bool initing, closing;
 static int tabs = 1; // int for more options than true/false
 enum { SVOID, SINT, SLEN, SINDEX, SCOLOR, SBOOL, SKEYMOD, SSTRING, SSTRINGRET };
+// Indexable Scintilla property of a buffer or view (e.g. `buffer.style_at`).
+// The buffer or view the property belongs to is the property userdata's user value.
+typedef struct {
+	int get_id, set_id, rtype, wtype;
+	SciObject *view; // the view the property belongs to, or NULL for a buffer
+} Property;
+// Read-only view of a range of a buffer's text (e.g. `buffer:text_view()`).
+// The buffer the text view belongs to is the text view userdata's user value.
+typedef struct {
+	sptr_t pos, len;
+	unsigned int version; // value of `text_version` when created
+} TextView;
+static unsigned int text_version; // incremented whenever any document's text changes
+// A file being loaded into a buffer in chunks (`io.loader()`).
+// The buffer is the loader userdata's user value.
+typedef struct {
+	FILE *f; // NULL when closed
+	iconv_t cd; // (iconv_t)-1 if not converting
+	bool validate; // whether or not to validate UTF-8 instead of converting
+	char *in, *out; // chunk and conversion buffers
+	size_t left; // number of unconverted bytes at the start of in carried over from the last chunk
+	long size; // file size
+	bool collect_undo; // whether or not the buffer collected undo history before loading
+} Loader;
+// An in-progress emission of an event, which iterates over that event's handlers.
+typedef struct EmitFrame {
+	int id, i, nargs; // id is the event's ID, and i is the handler index being called
+	struct EmitFrame *next; // any outer emission of the same event
+} EmitFrame;
+// An event's handlers, whose functions are in the event's handler table.
+// The handler table maps handler indices to their functions (or `false` if disconnected) and
+// handler functions to their indices. Handlers are ordered by descending priority.
+typedef struct {
+	int len, live; // live is the number of connected handlers
+	int *priorities, size; // priorities[i - 1] is the priority of handler index i
+	EmitFrame *frames; // in-progress emissions; handler indices only shift while there are none
+} Event;
+// Events indexed by event ID. The first IFACE_EVENT_COUNT IDs are Scintilla notifications'.
+static Event *event_list;
+static int num_events, max_events;
+static int modified_batch_id; // ID of `events.MODIFIED_BATCH`
+// A range of text inserted or deleted while batching modifications for `events.MODIFIED_BATCH`.
+typedef struct {
+	sptr_t pos, len;
+	int type; // modification type
+} Span;
+static Span *spans;
+static int num_spans, max_spans, batch_depth; // depth of `events.batch()` calls
+static sptr_t batch_doc; // the document whose modifications are being batched, if any
+// A buffer in the C-side mirror of `_BUFFERS`.
+typedef struct {
+	sptr_t doc;
+	int ref; // Lua registry reference to the buffer
+	int undo_depth; // depth of undo actions started from Lua
+} DocEntry;
+static DocEntry *docs; // `_BUFFERS[i]` is docs[i - 1]
+static int num_docs, max_docs, command_entry_ref = LUA_NOREF;
+// Open-addressed hash table of documents to their `_BUFFERS` indices (0 for an empty slot).
+static int *doc_indices, num_doc_indices; // num_doc_indices is a power of 2
+// Cumulative statistics for calls to a Scintilla message from Lua (`_SCINTILLA.stats()`).
+typedef struct {
+	lua_Integer calls, bytes; // bytes are string parameter and return bytes
+	double time; // in seconds
+} CallStats;
+#define MAX_MESSAGE 4096 // Scintilla message IDs are less than this
+static CallStats *call_stats; // indexed by message ID; allocated by `_SCINTILLA.profile()`
+static bool profiling;
+// Cumulative statistics for calls to an event's handler (`events.stats()`).
+typedef struct {
+	lua_Integer calls, bytes; // bytes are allocated bytes
+	double time, max_time; // in seconds
+} HandlerStats;
+static bool profiling_events;
+// Trace file that emitted events are recorded to (`events.record()`).
+// A trace starts with TRACE_MAGIC, followed by a record per event: a double timestamp in seconds
+// since recording started, a byte count of values, and then the values themselves (the event
+// name followed by its arguments). Each value is a Lua type byte followed by: nothing for nil,
+// a byte for a boolean, an int64_t for an integer, or a uint32_t length and bytes for a string.
+// Floats have the TRACE_TFLOAT type byte instead, followed by a double. Values are in native
+// byte order.
+static FILE *trace;
+static double trace_start;
+#define TRACE_MAGIC "TATRACE1"
+#define TRACE_TFLOAT 0x80
+// Number of event emissions from C in progress, and the depth at which events are recorded.
+// Events emitted any deeper are caused by handlers of recorded events, which replaying those
+// events calls again, so they are not recorded.
+static int emit_depth, record_depth;
+// Whether or not `events.replay()` is forwarding a key to Scintilla, and the notifications
+// Scintilla emitted while processing it.
+static bool forwarding_key, forwarded_notifications[IFACE_EVENT_COUNT];
+// The latency of a keystroke from the platform receiving it to the next paint.
+// Its parts are Lua key handling, Scintilla processing up until its next `SCN_UPDATEUI`, and
+// redrawing until `SCN_PAINTED`. All times are in seconds.
+typedef struct {
+	double total, lua, scintilla, redraw;
+} KeyLatency;
+#define MAX_KEY_LATENCIES 256 // ring buffer size
+#define KEY_LATENCY_TIMEOUT 1.0 // keystrokes that do not update a view by then are not sampled
+static KeyLatency key_latencies[MAX_KEY_LATENCIES];
+static int num_key_latencies, key_latency_index; // key_latency_index is the next slot to write
+// Times the pending keystroke was received, handled by Lua, and processed by Scintilla, or 0.
+static double key_time, key_handled_time, key_processed_time;
+// An open iconv conversion descriptor kept for reuse by one-shot conversions (`open_iconv()`).
+typedef struct {
+	char *to, *from; // NULL if unused
+	iconv_t cd;
+} IconvEntry;
+#define ICONV_CACHE_SIZE 8
+static IconvEntry iconv_cache[ICONV_CACHE_SIZE];
+static int iconv_cache_next; // index of the entry to replace next once all are in use
+// An incremental character set conversion (`string.iconv_stream()`).
+typedef struct {
+	iconv_t cd; // (iconv_t)-1 if not converting
+	char tail[MB_LEN_MAX]; // incomplete multi-byte sequence at the end of the last chunk
+	size_t left; // number of bytes in tail
+	bool finished;
+} IconvStream;
+// Output of `convert()`, which is kept out of Lua memory so converting never triggers a garbage
+// collection whose finalizers could reuse or close the cached conversion descriptor in use.
+typedef struct {
+	char *data;
+	size_t len, size;
+} ConvBuffer;
 LUALIB_API int luaopen_lpeg(lua_State *), luaopen_lfs(lua_State *), luaopen_regex(lua_State *);
 
 // Forward declarations.
 static void add_doc(sptr_t doc);
 static SciObject *new_view(sptr_t);
 static bool init_lua(int, char **);
+static void notified(SciObject *, int, SCNotification *, void *);
+static const char *luaL_checktext(lua_State *, int, size_t *);
+static void record_event(lua_State *, int);
+static double now(void);
 
 // Shows the given error in an error message dialog, as well as printing to stderr.
 static void show_error(const char *title, const char *message) {
@@ -54,12 +201,66 @@ static void show_error(const char *title, const char *message) {
 	lua_pop(lua, message_dialog(opts, lua)); // pop results
 }
 
+// Pushes onto the Lua stack `events`, `events.emit()`, and the given event name in preparation
+// for `call_emit()`, and returns whether or not `events.emit()` exists.
+static bool push_emit(const char *name) {
+	if (lua_getglobal(lua, "events") != LUA_TTABLE) return (lua_pop(lua, 1), false); // non-table
+	if (lua_getfield(lua, -1, "emit") != LUA_TFUNCTION) return (lua_pop(lua, 2), false); // non-func
+	return (lua_pushstring(lua, name), true);
+}
+
+// Calls the `events.emit()` pushed by `push_emit()` with the given number of arguments (including
+// the event name), and returns its result.
+static bool call_emit(int n) {
+	if (trace) record_event(lua, n);
+	int status = (emit_depth++, lua_pcall(lua, n, 1, 0));
+	if (emit_depth--, status != LUA_OK)
+		// An error occurred within `events.emit()` itself, not an event handler.
+		return (show_error("Error", lua_tostring(lua, -1)), lua_pop(lua, 2), false); // error, events
+	bool ret = lua_toboolean(lua, -1);
+	return (lua_pop(lua, 2), ret); // pop result, events
+}
+
+// Returns the ID of the given event, or -1 if it has never had handlers.
+static int event_id(lua_State *L, const char *name) {
+	lua_getfield(L, LUA_REGISTRYINDEX, EVENT_IDS);
+	int id = lua_getfield(L, -1, name) == LUA_TNUMBER ? lua_tointeger(L, -1) : -1;
+	return (lua_pop(L, 2), id); // pop id, EVENT_IDS
+}
+
+// Returns whether or not the given event has handlers.
+static bool is_handled(const char *name) {
+	int id = event_id(lua, name);
+	return id >= 0 && event_list[id].live > 0;
+}
+
+// Starts sampling the latency of a keystroke received at the given time and just handled by Lua.
+// Any previous keystroke that has yet to be painted is not sampled.
+static void key_emitted(double start) {
+	key_time = start, key_handled_time = now(), key_processed_time = 0;
+}
+
+// Records the latency of the pending keystroke, if any, after the given notification.
+static void key_notified(int code) {
+	double time = now();
+	if (time - key_time > KEY_LATENCY_TIMEOUT) key_time = 0; // e.g. a modifier key
+	else if (code == SCN_UPDATEUI && key_processed_time == 0)
+		key_processed_time = time;
+	else if (code == SCN_PAINTED && key_processed_time > 0) {
+		KeyLatency *latency = &key_latencies[key_latency_index];
+		latency->total = time - key_time, latency->lua = key_handled_time - key_time;
+		latency->scintilla = key_processed_time - key_handled_time;
+		latency->redraw = time - key_processed_time;
+		key_latency_index = (key_latency_index + 1) % MAX_KEY_LATENCIES;
+		if (num_key_latencies < MAX_KEY_LATENCIES) num_key_latencies++;
+		key_time = 0;
+	}
+}
+
 bool emit(const char *name, ...) {
-	bool ret = false;
-	if (lua_getglobal(lua, "events") != LUA_TTABLE) return (lua_pop(lua, 1), ret); // pop non-table
-	if (lua_getfield(lua, -1, "emit") != LUA_TFUNCTION) return (lua_pop(lua, 2), ret); // pop non-func
-	lua_pushstring(lua, name);
-	int n = 1, ref;
+	double start = strcmp(name, "key") == 0 ? now() : 0;
+	bool handled = is_handled(name) && push_emit(name);
+	int top = lua_gettop(lua), n = 1, ref;
 	va_list ap;
 	va_start(ap, name);
 	for (int type = va_arg(ap, int); type != -1; type = va_arg(ap, int), n++) switch (type) {
@@ -74,31 +275,169 @@ bool emit(const char *name, ...) {
 		default: lua_pushnil(lua);
 		}
 	va_end(ap);
-	if (lua_pcall(lua, n, 1, 0) != LUA_OK)
-		// An error occurred within `events.emit()` itself, not an event handler.
-		return (show_error("Error", lua_tostring(lua, -1)), lua_pop(lua, 2), ret); // pop error, events
-	ret = lua_toboolean(lua, -1);
-	return (lua_pop(lua, 2), ret); // pop result, events
+	bool ret = handled ? call_emit(n) : (lua_settop(lua, top), false); // table args are unref'ed
+	if (start > 0) key_emitted(start);
+	return ret;
+}
+
+// Returns a conversion descriptor in its initial state for converting text from one encoding
+// to another, or (iconv_t)-1 if either encoding is invalid.
+// Descriptors are cached for reuse and must not be closed or used across calls into Lua or
+// Lua allocations, since finalizers may convert text too.
+static iconv_t open_iconv(const char *to, const char *from) {
+	for (int i = 0; i < ICONV_CACHE_SIZE && iconv_cache[i].to; i++)
+		if (strcmp(iconv_cache[i].to, to) == 0 && strcmp(iconv_cache[i].from, from) == 0)
+			return (iconv(iconv_cache[i].cd, NULL, NULL, NULL, NULL), iconv_cache[i].cd);
+	iconv_t cd = iconv_open(to, from);
+	if (cd == (iconv_t)-1) return cd;
+	IconvEntry *entry = &iconv_cache[iconv_cache_next];
+	iconv_cache_next = (iconv_cache_next + 1) % ICONV_CACHE_SIZE;
+	if (entry->to) free(entry->to), free(entry->from), iconv_close(entry->cd);
+	*entry = (IconvEntry){strdup(to), strdup(from), cd};
+	return cd;
+}
+
+#define ICONV_CHUNK_SIZE 65536 // maximum number of bytes converted at a time
+
+// Pushes onto the Lua stack the given text, which is from the string or text view at the given
+// function argument, without copying strings.
+static void push_text(lua_State *L, int arg, const char *text, size_t len) {
+	if (lua_type(L, arg) == LUA_TSTRING)
+		lua_pushvalue(L, arg);
+	else
+		lua_pushlstring(L, text, len);
+}
+
+// Converts as much of the given text as possible with the given conversion descriptor, adding
+// the result to the given buffer, and returns whether or not all of it was converted.
+// If *inbuf is NULL, writes any sequence that returns the descriptor to its initial state.
+// On failure, errno is EINVAL if the text ends with an incomplete multi-byte sequence, which
+// *inbuf and *inbytesleft then refer to.
+static bool convert(iconv_t cd, char **inbuf, size_t *inbytesleft, ConvBuffer *buf) {
+	// Ensure the output size can hold a potential output BOM and one multibyte character.
+	size_t size = fmin(4 + fmax(*inbuf ? *inbytesleft : 0, MB_LEN_MAX), ICONV_CHUNK_SIZE);
+	for (;;) {
+		if (buf->size - buf->len < size) {
+			size_t new_size = fmax(2 * buf->size, buf->len + size);
+			char *data = realloc(buf->data, new_size);
+			if (!data) return (errno = ENOMEM, false);
+			buf->data = data, buf->size = new_size;
+		}
+		char *p = buf->data + buf->len;
+		size_t outbytesleft = buf->size - buf->len;
+		size_t n = iconv(cd, inbuf, inbytesleft, &p, &outbytesleft);
+		buf->len = p - buf->data;
+		if (n != (size_t)-1) return true;
+		if (errno != E2BIG) return false;
+	}
+}
+
+// Pushes onto the Lua stack the text converted into the given buffer, and frees that buffer.
+static void push_converted(lua_State *L, ConvBuffer *buf) {
+	lua_pushlstring(L, buf->data ? buf->data : "", buf->len), free(buf->data);
 }
 
 // `string.iconv()` Lua function.
 static int iconv_lua(lua_State *L) {
-	size_t inbytesleft = 0;
-	char *inbuf = (char *)luaL_checklstring(L, 1, &inbytesleft);
+	size_t inbytesleft = 0, zero = 0;
+	char *inbuf = (char *)luaL_checktext(L, 1, &inbytesleft), *none = NULL;
 	const char *to = luaL_checkstring(L, 2), *from = luaL_checkstring(L, 3);
-	iconv_t cd = iconv_open(to, from);
+	if (strcmp(to, from) == 0) return (push_text(L, 1, inbuf, inbytesleft), 1);
+	iconv_t cd = open_iconv(to, from);
 	if (cd == (iconv_t)-1) return luaL_error(L, "invalid encoding(s)");
-	luaL_Buffer buf;
-	luaL_buffinit(L, &buf);
-	// Ensure the minimum buffer size can hold a potential output BOM and one multibyte character.
-	size_t bufsiz = 4 + fmax(inbytesleft, MB_LEN_MAX), outbytesleft = bufsiz;
-	char *outbuf = malloc(bufsiz + 1), *p = outbuf;
-	while (iconv(cd, &inbuf, &inbytesleft, &p, &outbytesleft) == (size_t)-1) {
-		if (errno != E2BIG) return (free(outbuf), iconv_close(cd), luaL_error(L, "conversion failed"));
-		luaL_addlstring(&buf, outbuf, p - outbuf), p = outbuf, outbytesleft = bufsiz;
+	ConvBuffer buf = {NULL, 0, 0};
+	if (!convert(cd, &inbuf, &inbytesleft, &buf) || !convert(cd, &none, &zero, &buf))
+		return (free(buf.data), luaL_error(L, "conversion failed"));
+	return (push_converted(L, &buf), 1);
+}
+
+// `stream:feed()` Lua method.
+static int iconv_stream_feed(lua_State *L) {
+	IconvStream *stream = luaL_checkudata(L, 1, "ta_iconv_stream");
+	luaL_argcheck(L, !stream->finished, 1, "stream is finished");
+	size_t inbytesleft;
+	char *inbuf = (char *)luaL_checktext(L, 2, &inbytesleft);
+	if (stream->cd == (iconv_t)-1) return (push_text(L, 2, inbuf, inbytesleft), 1);
+	if (stream->left > 0) // prepend the incomplete sequence from the last chunk
+		lua_pushlstring(L, stream->tail, stream->left), lua_pushlstring(L, inbuf, inbytesleft),
+			lua_concat(L, 2), inbuf = (char *)lua_tolstring(L, -1, &inbytesleft);
+	ConvBuffer buf = {NULL, 0, 0};
+	if (!convert(stream->cd, &inbuf, &inbytesleft, &buf) &&
+		(errno != EINVAL || inbytesleft > sizeof(stream->tail)))
+		return (free(buf.data), luaL_error(L, "conversion failed"));
+	memcpy(stream->tail, inbuf, stream->left = inbytesleft);
+	return (push_converted(L, &buf), 1);
+}
+
+// Closes the given stream's conversion descriptor.
+static void close_iconv_stream(IconvStream *stream) {
+	if (stream->finished) return;
+	if (stream->cd != (iconv_t)-1) iconv_close(stream->cd);
+	stream->finished = true;
+}
+
+// `stream:finish()` Lua method.
+static int iconv_stream_finish(lua_State *L) {
+	IconvStream *stream = luaL_checkudata(L, 1, "ta_iconv_stream");
+	luaL_argcheck(L, !stream->finished, 1, "stream is finished");
+	ConvBuffer buf = {NULL, 0, 0};
+	char *none = NULL;
+	size_t zero = 0;
+	// Flush any shift sequence and ensure the text did not end mid-sequence.
+	bool ok = stream->left == 0 &&
+		(stream->cd == (iconv_t)-1 || convert(stream->cd, &none, &zero, &buf));
+	close_iconv_stream(stream);
+	if (!ok) return (free(buf.data), luaL_error(L, "conversion failed"));
+	return (push_converted(L, &buf), 1);
+}
+
+// `stream.__gc` and `stream.__close` metamethods.
+static int iconv_stream_close(lua_State *L) {
+	return (close_iconv_stream(luaL_checkudata(L, 1, "ta_iconv_stream")), 0);
+}
+
+// `string.iconv_stream()` Lua function.
+static int iconv_stream_lua(lua_State *L) {
+	const char *to = luaL_checkstring(L, 1), *from = luaL_checkstring(L, 2);
+	// Streams keep their conversion state between calls, so they cannot share cached descriptors.
+	iconv_t cd = strcmp(to, from) != 0 ? iconv_open(to, from) : (iconv_t)-1;
+	if (strcmp(to, from) != 0 && cd == (iconv_t)-1) return luaL_error(L, "invalid encoding(s)");
+	IconvStream *stream = lua_newuserdatauv(L, sizeof(IconvStream), 0);
+	stream->cd = cd, stream->left = 0, stream->finished = false;
+	if (luaL_newmetatable(L, "ta_iconv_stream")) {
+		const luaL_Reg methods[] = {
+			{"feed", iconv_stream_feed}, {"finish", iconv_stream_finish}, {NULL, NULL}};
+		luaL_newlib(L, methods), lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, iconv_stream_close), lua_setfield(L, -2, "__gc");
+		lua_pushcfunction(L, iconv_stream_close), lua_setfield(L, -2, "__close");
 	}
-	luaL_addlstring(&buf, outbuf, p - outbuf), lua_checkstack(L, 1), luaL_pushresult(&buf);
-	return (free(outbuf), iconv_close(cd), 1);
+	return (lua_setmetatable(L, -2), 1);
+}
+
+// `string.utf8_valid()` Lua function.
+static int utf8_valid_lua(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktext(L, 1, &len);
+	return (lua_pushboolean(L, utf8_valid(text, len)), 1);
+}
+
+// `string.utf8_count()` Lua function.
+static int utf8_count_lua(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktext(L, 1, &len);
+	return (lua_pushinteger(L, utf8_count(text, len)), 1);
+}
+
+// `string.find_byte()` Lua function.
+static int find_byte_lua(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktext(L, 1, &len);
+	int c = lua_isinteger(L, 2) ? lua_tointeger(L, 2) : *luaL_checkstring(L, 2);
+	lua_Integer init = luaL_optinteger(L, 3, 1), n = len;
+	if (init < 0) init = n + init + 1 > 1 ? n + init + 1 : 1;
+	if (init == 0) init = 1;
+	const char *p = init <= n ? find_byte(text + init - 1, n - init + 1, c) : NULL;
+	return (p ? lua_pushinteger(L, p - text + 1) : lua_pushnil(L), 1);
 }
 
 void process_output(Process *proc, const char *buf, size_t len, bool is_stdout) {
@@ -317,11 +656,25 @@ static sptr_t lua_todoc(lua_State *L, int index) {
 	return (lua_pop(L, 1), doc); // pop doc_pointer
 }
 
-// Pushes the given Scintilla document onto the Lua stack.
-// The document must have previously been added with `add_doc()`.
-static void lua_pushdoc(lua_State *L, sptr_t doc) {
-	lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_rawgetp(L, -1, (sptr_t *)doc),
-		lua_replace(L, -2);
+// Returns the `doc_indices` slot for the given Scintilla document.
+static int doc_slot(sptr_t doc) {
+	unsigned int mask = num_doc_indices - 1, i = ((uintptr_t)doc >> 4) * 2654435761u & mask;
+	while (doc_indices[i] && docs[doc_indices[i] - 1].doc != doc) i = (i + 1) & mask;
+	return i;
+}
+
+// Returns the `_BUFFERS` index of the given Scintilla document, or 0 if it has none.
+static int doc_index(sptr_t doc) { return num_doc_indices ? doc_indices[doc_slot(doc)] : 0; }
+
+// Rebuilds `doc_indices` after `docs` has changed, growing it if necessary.
+static void rehash_docs(void) {
+	if (num_doc_indices < 2 * num_docs) {
+		while (num_doc_indices < 2 * num_docs)
+			num_doc_indices = num_doc_indices ? 2 * num_doc_indices : 16;
+		doc_indices = realloc(doc_indices, num_doc_indices * sizeof(int));
+	}
+	memset(doc_indices, 0, num_doc_indices * sizeof(int));
+	for (int i = 0; i < num_docs; i++) doc_indices[doc_slot(docs[i].doc)] = i + 1;
 }
 
 // Returns whether or not the given document is the command entry.
@@ -329,22 +682,54 @@ static bool is_command_entry(sptr_t doc) {
 	return doc == SS(command_entry, SCI_GETDOCPOINTER, 0, 0);
 }
 
+// Pushes the given Scintilla document onto the Lua stack.
+// The document must have previously been added with `add_doc()`. Otherwise, pushes nil.
+static void lua_pushdoc(lua_State *L, sptr_t doc) {
+	int i = doc_index(doc);
+	if (i || is_command_entry(doc))
+		lua_rawgeti(L, LUA_REGISTRYINDEX, i ? docs[i - 1].ref : command_entry_ref);
+	else
+		lua_pushnil(L);
+}
+
+// Returns a view from `dummy_views` with the given Scintilla document loaded in it.
+// If the document is not already loaded, loads it in the least recently used view.
+static SciObject *dummy_view_for_doc(sptr_t doc) {
+	int i = 0;
+	while (i < num_dummy_views - 1 && dummy_views[i] &&
+		SS(dummy_views[i], SCI_GETDOCPOINTER, 0, 0) != doc)
+		i++;
+	SciObject *view = dummy_views[i];
+	if (!view) {
+		view = dummy_views[i] = new_scintilla(notified);
+		// Only notify of text changes in order to invalidate text views.
+		SS(view, SCI_SETMODEVENTMASK, SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT, 0);
+	}
+	if (SS(view, SCI_GETDOCPOINTER, 0, 0) != doc)
+		SS(view, SCI_SETDOCPOINTER, 0, doc), dummy_view_rebinds++;
+	memmove(&dummy_views[1], &dummy_views[0], i * sizeof(SciObject *)), dummy_views[0] = view;
+	return view;
+}
+
+// Unloads the given Scintilla document from any views in `dummy_views`.
+static void unload_dummy_doc(sptr_t doc) {
+	for (int i = 0; i < MAX_DUMMY_VIEWS && dummy_views[i]; i++)
+		if (SS(dummy_views[i], SCI_GETDOCPOINTER, 0, 0) == doc)
+			SS(dummy_views[i], SCI_SETDOCPOINTER, 0, 0);
+}
+
 // Returns a suitable Scintilla view that can operate on the Scintilla document on the Lua
 // stack at the given index.
-// For non-global, non-command entry documents, loads that document in `dummy_view` (unless
-// it is already loaded). Raises and error if the value is not a Scintilla document or if the
-// document no longer exists.
+// For non-global, non-command entry documents, loads that document in one of `dummy_views`
+// (unless it is already loaded). Raises and error if the value is not a Scintilla document or
+// if the document no longer exists.
 static SciObject *view_for_doc(lua_State *L, int index) {
 	luaL_argcheck(L, is_type(L, index, "ta_buffer"), index, "Buffer expected");
 	sptr_t doc = lua_todoc(L, index);
 	if (doc == SS(focused_view, SCI_GETDOCPOINTER, 0, 0)) return focused_view;
-	luaL_argcheck(L,
-		(lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_pushdoc(L, doc), lua_gettable(L, -2)), index,
-		"this Buffer does not exist"),
-		lua_pop(L, 2); // pop buffer, _BUFFERS
 	if (is_command_entry(doc)) return command_entry;
-	if (doc == SS(dummy_view, SCI_GETDOCPOINTER, 0, 0)) return dummy_view;
-	return (SS(dummy_view, SCI_SETDOCPOINTER, 0, doc), dummy_view);
+	luaL_argcheck(L, doc_index(doc), index, "this Buffer does not exist");
+	return dummy_view_for_doc(doc);
 }
 
 // Returns the Scintilla view on the Lua stack at the given acceptable index.
@@ -368,6 +753,82 @@ static sptr_t luaL_checkscintilla(lua_State *L, int *arg, int type) {
 	return type >= SINT && type <= SKEYMOD ? luaL_checkinteger(L, (*arg)++) : 0;
 }
 
+// Returns the current time in seconds.
+static double now(void) {
+	struct timespec ts;
+	return (timespec_get(&ts, TIME_UTC), ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+// Records a call to the given Scintilla message that started at the given time and transferred
+// the given number of string bytes.
+static void record_call(int msg, double start, sptr_t bytes) {
+	if (msg < 0 || msg >= MAX_MESSAGE) return;
+	CallStats *stats = &call_stats[msg];
+	stats->calls++, stats->time += now() - start, stats->bytes += bytes;
+}
+
+// Records the given Scintilla modification in the given document for `events.MODIFIED_BATCH`
+// if that document's modifications are being batched and that event has handlers.
+// Contiguous insertions and deletions are merged into a single span.
+static void batch_modification(sptr_t doc, SCNotification *n) {
+	int type = n->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+	if (doc != batch_doc || !type || event_list[modified_batch_id].live == 0) return;
+	Span *last = num_spans > 0 ? &spans[num_spans - 1] : NULL;
+	if (last && (last->type & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)) == type) {
+		if (type == SC_MOD_INSERTTEXT ? n->position == last->pos + last->len : // typed or appended
+				n->position == last->pos) { // deleted forward
+			last->len += n->length;
+			return;
+		} else if (type == SC_MOD_DELETETEXT && n->position + n->length == last->pos) {
+			last->pos = n->position, last->len += n->length; // deleted backward
+			return;
+		}
+	}
+	if (num_spans == max_spans)
+		spans = realloc(spans, (max_spans = fmax(2 * max_spans, 16)) * sizeof(Span));
+	spans[num_spans++] = (Span){n->position, n->length, n->modificationType};
+}
+
+// Returns the depth of undo actions started from Lua in the given document, or NULL if the
+// document is not a buffer (e.g. it is the command entry's).
+static int *undo_depth(sptr_t doc) {
+	int i = doc_index(doc);
+	return i ? &docs[i - 1].undo_depth : NULL;
+}
+
+// Starts batching modifications in the given document (the current buffer's), unless they are
+// already being batched.
+static void begin_batch(sptr_t doc) {
+	if (!batch_doc) batch_doc = doc, num_spans = 0;
+}
+
+// Stops batching modifications and discards any recorded ones.
+// Since an error or a buffer switch may have skipped the end of an undo action, the batched
+// document's undo action depth is reset too.
+static void reset_batch(void) {
+	int *depth = undo_depth(batch_doc);
+	if (depth) *depth = 0;
+	batch_doc = 0, num_spans = 0;
+}
+
+// Ends batching modifications if there are no more `events.batch()` calls or undo actions
+// in progress for the batched document, and emits `events.MODIFIED_BATCH` with the
+// modifications recorded during the batch.
+static void end_batch(void) {
+	int *depth = undo_depth(batch_doc);
+	if (!batch_doc || batch_depth > 0 || (depth && *depth > 0)) return;
+	if (batch_doc = 0, num_spans == 0) return;
+	lua_createtable(lua, num_spans, 0);
+	for (int i = 0; i < num_spans; i++) {
+		lua_createtable(lua, 0, 3);
+		lua_pushinteger(lua, spans[i].pos + 1), lua_setfield(lua, -2, "position");
+		lua_pushinteger(lua, spans[i].len), lua_setfield(lua, -2, "length");
+		lua_pushinteger(lua, spans[i].type), lua_setfield(lua, -2, "modification_type");
+		lua_rawseti(lua, -2, i + 1);
+	}
+	num_spans = 0, emit("modified_batch", LUA_TTABLE, luaL_ref(lua, LUA_REGISTRYINDEX), -1);
+}
+
 // Sends a message to the given Scintilla view (i.e. calls a Scintilla function) using the
 // given message identifier and parameter types.
 // Lua values to pass start at the given Lua stack index. This function does not remove any
@@ -377,8 +838,9 @@ static int call_scintilla(
 	uptr_t wparam = 0;
 	sptr_t lparam = 0, len = 0;
 	int params_needed = 2, nresults = 0;
-	bool string_return = false;
+	bool string_return = false, profile = profiling;
 	char *text = NULL;
+	double start = 0;
 
 	// Set wParam and lParam appropriately for Scintilla based on wtype and ltype.
 	if (wtype == SLEN && ltype == SSTRING)
@@ -388,6 +850,7 @@ static int call_scintilla(
 		string_return = true, params_needed = wtype == SLEN ? 0 : 1;
 	if (params_needed > 0) wparam = luaL_checkscintilla(L, &arg, wtype);
 	if (params_needed > 1) lparam = luaL_checkscintilla(L, &arg, ltype);
+	if (profile) start = now();
 	if (string_return) { // create a buffer for the return string
 		lparam = (sptr_t)(text = malloc((len = SS(view, msg, wparam, 0)) + 1));
 		if (wtype == SLEN) wparam = len;
@@ -395,6 +858,19 @@ static int call_scintilla(
 
 	// Send the message to Scintilla and return the appropriate values.
 	sptr_t result = SS(view, msg, wparam, lparam);
+	if (msg == SCI_BEGINUNDOACTION || msg == SCI_ENDUNDOACTION) {
+		sptr_t doc = SS(view, SCI_GETDOCPOINTER, 0, 0);
+		int *depth = undo_depth(doc);
+		if (depth && msg == SCI_BEGINUNDOACTION && (*depth)++ == 0 && view == focused_view)
+			begin_batch(doc);
+		if (depth && msg == SCI_ENDUNDOACTION && *depth > 0 && --(*depth) == 0) end_batch();
+	}
+	if (profile) {
+		sptr_t bytes = string_return ? len : params_needed == 0 ? (sptr_t)wparam : 0;
+		if (params_needed > 0 && wtype == SSTRING) bytes += strlen((char *)wparam);
+		if (params_needed > 1 && ltype == SSTRING) bytes += strlen((char *)lparam);
+		record_call(msg, start, bytes);
+	}
 	if (string_return) lua_pushlstring(L, text, len), nresults++, free(text);
 	if (rtype == SINDEX && result >= 0) result++;
 	if (rtype > SVOID && rtype < SBOOL)
@@ -410,6 +886,7 @@ int get_int_field(lua_State *L, int index, int n) {
 }
 
 // `buffer:method()` Lua function.
+// Upvalues are the Scintilla function's message ID, wParam type, lParam type, and return type.
 static int call_scintilla_lua(lua_State *L) {
 	SciObject *view = focused_view;
 	// If optional buffer/view argument is given, check it.
@@ -417,12 +894,526 @@ static int call_scintilla_lua(lua_State *L) {
 		view = view_for_doc(L, 1);
 	else if (is_type(L, 1, "ta_view"))
 		view = lua_toview(L, 1);
-	// Interface table is of the form {msg, rtype, wtype, ltype}.
-	return call_scintilla(L, view, get_int_field(L, lua_upvalueindex(1), 1),
-		get_int_field(L, lua_upvalueindex(1), 3), get_int_field(L, lua_upvalueindex(1), 4),
-		get_int_field(L, lua_upvalueindex(1), 2), lua_istable(L, 1) ? 2 : 1);
+	return call_scintilla(L, view, lua_tointeger(L, lua_upvalueindex(1)),
+		lua_tointeger(L, lua_upvalueindex(2)), lua_tointeger(L, lua_upvalueindex(3)),
+		lua_tointeger(L, lua_upvalueindex(4)), lua_istable(L, 1) ? 2 : 1);
+}
+
+// Returns the interface entry for the Scintilla function or property name at the given Lua
+// stack index, or NULL if the value there is not one.
+static const IfaceEntry *lua_toiface(lua_State *L, int index) {
+	return lua_type(L, index) == LUA_TSTRING ? find_iface(lua_tostring(L, index)) : NULL;
+}
+
+// Pushes onto the Lua stack a `buffer:method()` closure for the given Scintilla function, and
+// caches it in the 'functions' registry table at the given index under the key at index 2 (the
+// function name).
+// Buffers and views share closures, so each Scintilla function is only ever allocated once.
+static void push_function(lua_State *L, int functions, const IfaceEntry *iface) {
+	lua_pushinteger(L, iface->msg), lua_pushinteger(L, iface->wtype),
+		lua_pushinteger(L, iface->ltype), lua_pushinteger(L, iface->rtype),
+		lua_pushcclosure(L, call_scintilla_lua, 4);
+	lua_pushvalue(L, 2), lua_pushvalue(L, -2), lua_rawset(L, functions); // t[name] = closure
+}
+
+// `buffer:styles_in_range()` Lua function.
+static int styles_in_range(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	sptr_t s = luaL_checkinteger(L, 2) - 1, e = luaL_checkinteger(L, 3) - 1,
+				 len = SS(view, SCI_GETLENGTH, 0, 0);
+	luaL_argcheck(L, s >= 0 && s <= len, 2, "position out of range");
+	if (e > len) e = len;
+	sptr_t n = e > s ? e - s : 0;
+	char *text = malloc(2 * n + 2); // character and style byte pairs, plus two NULs
+	if (!text) return luaL_error(L, "not enough memory");
+	struct Sci_TextRangeFull range = {{s, s + n}, text};
+	SS(view, SCI_GETSTYLEDTEXTFULL, 0, (sptr_t)&range);
+	lua_createtable(L, n, 0);
+	for (sptr_t i = 0; i < n; i++)
+		lua_pushinteger(L, (unsigned char)text[2 * i + 1] + 1), lua_rawseti(L, -2, i + 1);
+	return (free(text), 1);
+}
+
+// `buffer:style_run()` Lua function.
+static int style_run(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	sptr_t pos = luaL_checkinteger(L, 2) - 1, len = SS(view, SCI_GETLENGTH, 0, 0), s = pos,
+				 e = pos + 1;
+	luaL_argcheck(L, pos >= 0 && pos <= len, 2, "position out of range");
+	int style = SS(view, SCI_GETSTYLEINDEXAT, pos, 0);
+	while (s > 0 && SS(view, SCI_GETSTYLEINDEXAT, s - 1, 0) == style) s--;
+	while (e < len && SS(view, SCI_GETSTYLEINDEXAT, e, 0) == style) e++;
+	return (lua_pushinteger(L, s + 1), lua_pushinteger(L, e + 1), 2);
+}
+
+// Pushes onto the Lua stack a list of the results of sending the given Scintilla message for
+// each line in the optional range given by arguments 2 and 3 of a `buffer:method()` call.
+static int push_line_values(lua_State *L, int msg) {
+	SciObject *view = view_for_doc(L, 1);
+	sptr_t first = luaL_optinteger(L, 2, 1) - 1,
+				 last = luaL_optinteger(L, 3, SS(view, SCI_GETLINECOUNT, 0, 0)) - 1;
+	lua_createtable(L, last >= first ? last - first + 1 : 0, 0);
+	for (sptr_t line = first; line <= last; line++)
+		lua_pushinteger(L, SS(view, msg, line, 0)), lua_rawseti(L, -2, line - first + 1);
+	return 1;
+}
+
+// `buffer:line_states()` Lua function.
+static int line_states(lua_State *L) { return push_line_values(L, SCI_GETLINESTATE); }
+
+// `buffer:fold_levels()` Lua function.
+static int fold_levels(lua_State *L) { return push_line_values(L, SCI_GETFOLDLEVEL); }
+
+// `buffer:indicator_ranges()` Lua function.
+static int indicator_ranges(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	int indic = luaL_checkinteger(L, 2) - 1, n = 1;
+	sptr_t len = SS(view, SCI_GETLENGTH, 0, 0), pos = luaL_optinteger(L, 3, 1) - 1,
+				 end = luaL_optinteger(L, 4, len + 1) - 1;
+	lua_newtable(L);
+	while (pos < end) {
+		sptr_t e = SS(view, SCI_INDICATOREND, indic, pos);
+		if (e <= pos || e > end) e = end; // last run
+		if (SS(view, SCI_INDICATORVALUEAT, indic, pos))
+			lua_pushinteger(L, pos + 1), lua_rawseti(L, -2, n++), lua_pushinteger(L, e + 1),
+				lua_rawseti(L, -2, n++);
+		pos = e;
+	}
+	return 1;
+}
+
+// Returns a pointer to the text of the text view at the given function argument, and stores
+// that text's length in *len.
+// Raises an error if any document's text has changed since the text view was created.
+static const char *luaL_checktextview(lua_State *L, int arg, size_t *len) {
+	TextView *tv = luaL_checkudata(L, arg, "ta_textview");
+	luaL_argcheck(L, tv->version == text_version, arg, "text view invalidated by a text change");
+	SciObject *view = (lua_getiuservalue(L, arg, 1), view_for_doc(L, -1));
+	lua_pop(L, 1); // buffer
+	// Fetch the pointer each time since Scintilla may have moved its gap in the meantime.
+	return (*len = tv->len, (const char *)SS(view, SCI_GETRANGEPOINTER, tv->pos, tv->len));
+}
+
+// Returns the string or text view at the given function argument, and stores its length in
+// *len.
+static const char *luaL_checktext(lua_State *L, int arg, size_t *len) {
+	return is_type(L, arg, "ta_textview") ? luaL_checktextview(L, arg, len) :
+																					luaL_checklstring(L, arg, len);
+}
+
+// `textview:sub()` Lua function.
+static int text_view_sub(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktextview(L, 1, &len);
+	lua_Integer i = luaL_optinteger(L, 2, 1), j = luaL_optinteger(L, 3, -1), n = len;
+	if (i < 0) i = n + i + 1 > 1 ? n + i + 1 : 1;
+	if (i == 0) i = 1;
+	if (j < 0) j = n + j + 1;
+	if (j > n) j = n;
+	return (i <= j ? lua_pushlstring(L, text + i - 1, j - i + 1) : lua_pushliteral(L, ""), 1);
+}
+
+// `textview:write()` Lua function.
+static int text_view_write(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktextview(L, 1, &len);
+	luaL_Stream *stream = luaL_checkudata(L, 2, LUA_FILEHANDLE);
+	luaL_argcheck(L, stream->closef, 2, "attempt to use a closed file");
+	if (fwrite(text, 1, len, stream->f) < len) return luaL_fileresult(L, 0, NULL);
+	return (lua_settop(L, 2), 1); // return file
+}
+
+// `textview.__len` metamethod.
+static int text_view_len(lua_State *L) {
+	size_t len;
+	return (luaL_checktextview(L, 1, &len), lua_pushinteger(L, len), 1);
+}
+
+// `textview.__tostring` metamethod.
+static int text_view_tostring(lua_State *L) {
+	size_t len;
+	const char *text = luaL_checktextview(L, 1, &len);
+	return (lua_pushlstring(L, text, len), 1);
+}
+
+// `buffer:text_view()` Lua function.
+static int text_view(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	sptr_t len = SS(view, SCI_GETLENGTH, 0, 0), s = luaL_optinteger(L, 2, 1) - 1,
+				 e = luaL_optinteger(L, 3, len + 1) - 1;
+	luaL_argcheck(L, s >= 0 && s <= len, 2, "position out of range");
+	luaL_argcheck(L, e >= s && e <= len, 3, "position out of range");
+	TextView *tv = lua_newuserdatauv(L, sizeof(TextView), 1);
+	tv->pos = s, tv->len = e - s, tv->version = text_version;
+	lua_pushvalue(L, 1), lua_setiuservalue(L, -2, 1);
+	if (luaL_newmetatable(L, "ta_textview")) {
+		const luaL_Reg methods[] = {
+			{"sub", text_view_sub}, {"write", text_view_write}, {"iconv", iconv_lua}, {NULL, NULL}};
+		luaL_newlib(L, methods), lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, text_view_len), lua_setfield(L, -2, "__len");
+		lua_pushcfunction(L, text_view_tostring), lua_setfield(L, -2, "__tostring");
+	}
+	return (lua_setmetatable(L, -2), 1);
+}
+
+#define LOAD_CHUNK_SIZE 65536 // number of bytes a loader reads at a time
+
+// Closes the given loader's file and conversion descriptor, and frees its buffers.
+static void close_loader(Loader *loader) {
+	if (!loader->f) return;
+	fclose(loader->f), loader->f = NULL, free(loader->in), free(loader->out);
+	if (loader->cd != (iconv_t)-1) iconv_close(loader->cd);
+}
+
+// Sends the given text-modifying message to the given view regardless of its read-only state.
+static void modify_text(SciObject *view, int msg, size_t len, const char *text) {
+	bool read_only = SS(view, SCI_GETREADONLY, 0, 0);
+	if (read_only) SS(view, SCI_SETREADONLY, 0, 0);
+	SS(view, msg, len, (sptr_t)text);
+	if (read_only) SS(view, SCI_SETREADONLY, 1, 0);
+}
+
+// Appends the given text to the buffer of the loader at index 1 on the Lua stack.
+// Resolves the view each time since notifications may load other buffers into `dummy_views`.
+static void loader_append(lua_State *L, const char *text, size_t len) {
+	lua_getiuservalue(L, 1, 1), modify_text(view_for_doc(L, -1), SCI_APPENDTEXT, len, text),
+		lua_pop(L, 1); // pop buffer
+}
+
+// `loader:load()` Lua method.
+static int loader_load(lua_State *L) {
+	Loader *loader = luaL_checkudata(L, 1, "ta_loader");
+	luaL_argcheck(L, loader->f, 1, "loader is closed");
+	lua_Integer chunks = luaL_optinteger(L, 2, LUA_MAXINTEGER);
+	double deadline = lua_isnoneornil(L, 3) ? HUGE_VAL : now() + luaL_checknumber(L, 3);
+	// Read and append chunks, converting them to UTF-8 if necessary. Converted chunks are appended
+	// whenever the output buffer fills, and any incomplete multi-byte sequence at the end of a
+	// chunk is carried over to the start of the next one.
+	bool converting = loader->cd != (iconv_t)-1, ok = true;
+	char *in = loader->in, *out = loader->out, *p = out;
+	size_t n = 0, outbytesleft = 2 * LOAD_CHUNK_SIZE;
+	while (ok && chunks-- > 0 && now() < deadline &&
+		(n = fread(in + loader->left, 1, LOAD_CHUNK_SIZE - loader->left, loader->f)) > 0) {
+		if (loader->validate) {
+			ptrdiff_t len = utf8_prefix(in, loader->left + n);
+			if (!(ok = len >= 0)) break;
+			loader_append(L, in, len), memmove(in, in + len, loader->left = loader->left + n - len);
+			continue;
+		} else if (!converting) {
+			loader_append(L, in, n);
+			continue;
+		}
+		char *inbuf = in;
+		size_t inbytesleft = loader->left + n;
+		while (ok && iconv(loader->cd, &inbuf, &inbytesleft, &p, &outbytesleft) == (size_t)-1) {
+			if (errno == EINVAL) break; // incomplete sequence; carry it over
+			if (!(ok = errno == E2BIG)) break;
+			loader_append(L, out, p - out), p = out, outbytesleft = 2 * LOAD_CHUNK_SIZE;
+		}
+		loader_append(L, out, p - out), p = out, outbytesleft = 2 * LOAD_CHUNK_SIZE;
+		memmove(in, inbuf, loader->left = inbytesleft);
+	}
+	if (ok && !feof(loader->f) && !ferror(loader->f)) {
+		long pos = ftell(loader->f);
+		return (lua_pushboolean(L, false),
+			lua_pushnumber(L, loader->size > 0 ? (double)pos / loader->size : 0), 2);
+	}
+	if (ok && converting) // flush any shift sequence and ensure the file did not end mid-sequence
+		ok = iconv(loader->cd, NULL, NULL, &p, &outbytesleft) != (size_t)-1 && loader->left == 0,
+		loader_append(L, out, p - out);
+	else if (ok && loader->validate)
+		ok = loader->left == 0; // the file did not end mid-character
+	bool read_error = ferror(loader->f);
+	// Keep a loader that failed to validate UTF-8 open at the start of the invalid chunk so
+	// `loader:reencode()` can continue from there.
+	if (ok || !loader->validate || fseek(loader->f, -(long)(loader->left + n), SEEK_CUR) != 0)
+		close_loader(loader);
+	else
+		loader->left = 0;
+	SciObject *view = (lua_getiuservalue(L, 1, 1), view_for_doc(L, -1));
+	if (loader->collect_undo) SS(view, SCI_SETUNDOCOLLECTION, 1, 0);
+	SS(view, SCI_EMPTYUNDOBUFFER, 0, 0);
+	if (read_error) return luaL_fileresult(L, 0, NULL);
+	if (!ok) return luaL_error(L, "conversion failed");
+	return (lua_pushboolean(L, true), lua_pushnumber(L, 1), 2);
+}
+
+// `loader:reencode()` Lua method.
+static int loader_reencode(lua_State *L) {
+	Loader *loader = luaL_checkudata(L, 1, "ta_loader");
+	luaL_argcheck(L, loader->f && loader->validate, 1, "loader is not validating UTF-8");
+	iconv_t cd = iconv_open("UTF-8", luaL_checkstring(L, 2));
+	if (cd == (iconv_t)-1) return luaL_error(L, "invalid encoding(s)");
+	if (fseek(loader->f, -(long)loader->left, SEEK_CUR) != 0)
+		return (iconv_close(cd), luaL_fileresult(L, 0, NULL));
+	loader->left = 0;
+	// Convert the text loaded so far in memory, carrying over any incomplete multi-byte sequence
+	// at its end to the next chunk.
+	SciObject *view = (lua_getiuservalue(L, 1, 1), view_for_doc(L, -1));
+	size_t inbytesleft = SS(view, SCI_GETLENGTH, 0, 0);
+	char *inbuf = (char *)SS(view, SCI_GETRANGEPOINTER, 0, inbytesleft), *out = NULL;
+	ConvBuffer buf = {NULL, 0, 0};
+	if ((!convert(cd, &inbuf, &inbytesleft, &buf) && errno != EINVAL) ||
+		inbytesleft > LOAD_CHUNK_SIZE || !(out = malloc(2 * LOAD_CHUNK_SIZE)))
+		return (free(buf.data), iconv_close(cd), luaL_error(L, "conversion failed"));
+	memcpy(loader->in, inbuf, loader->left = inbytesleft);
+	SS(view, SCI_SETUNDOCOLLECTION, 0, 0), modify_text(view, SCI_CLEARALL, 0, NULL);
+	if (buf.len) modify_text(view, SCI_APPENDTEXT, buf.len, buf.data);
+	free(buf.data), loader->cd = cd, loader->validate = false, loader->out = out;
+	return 0;
+}
+
+// `loader:close()` Lua method and `loader.__gc` and `loader.__close` metamethods.
+static int loader_close(lua_State *L) {
+	return (close_loader(luaL_checkudata(L, 1, "ta_loader")), 0);
+}
+
+// `io.loader()` Lua function.
+static int loader_lua(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	const char *filename = luaL_checkstring(L, 2), *encoding = luaL_optstring(L, 3, NULL);
+	FILE *f = fopen(filename, "rb");
+	if (!f) return luaL_fileresult(L, 0, filename);
+	bool validate = encoding && strcmp(encoding, "UTF-8") == 0; // already UTF-8
+	if (validate) encoding = NULL;
+	iconv_t cd = encoding ? iconv_open("UTF-8", encoding) : (iconv_t)-1;
+	if (encoding && cd == (iconv_t)-1) return (fclose(f), luaL_error(L, "invalid encoding(s)"));
+	Loader *loader = lua_newuserdatauv(L, sizeof(Loader), 1);
+	*loader = (Loader){f, cd, validate, malloc(LOAD_CHUNK_SIZE),
+		encoding ? malloc(2 * LOAD_CHUNK_SIZE) : NULL, 0, 0, SS(view, SCI_GETUNDOCOLLECTION, 0, 0)};
+	lua_pushvalue(L, 1), lua_setiuservalue(L, -2, 1);
+	if (luaL_newmetatable(L, "ta_loader")) {
+		const luaL_Reg methods[] = {
+			{"load", loader_load}, {"reencode", loader_reencode}, {"close", loader_close}, {NULL, NULL}};
+		luaL_newlib(L, methods), lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, loader_close), lua_setfield(L, -2, "__gc");
+		lua_pushcfunction(L, loader_close), lua_setfield(L, -2, "__close");
+	}
+	lua_setmetatable(L, -2);
+	// Replace the buffer's text without collecting undo history, pre-allocating for the file.
+	if (fseek(f, 0, SEEK_END) == 0 && (loader->size = ftell(f)) > 0)
+		SS(view, SCI_ALLOCATE, loader->size, 0);
+	SS(view, SCI_SETUNDOCOLLECTION, 0, 0), modify_text(view, SCI_CLEARALL, 0, NULL);
+	return (rewind(f), 1);
+}
+
+// `io.load_into()` Lua function.
+static int load_into_lua(lua_State *L) {
+	int n = (lua_settop(L, 3), loader_lua(L));
+	if (n > 1) return n; // nil, error message, error code
+	n = (lua_replace(L, 1), lua_settop(L, 1), lua_toclose(L, 1), loader_load(L));
+	return n == 2 ? (lua_pop(L, 1), 1) : n; // pop progress
+}
+
+// `io.detect_encoding()` Lua function.
+static int detect_encoding_lua(lua_State *L) {
+	const char *filename = luaL_checkstring(L, 1);
+	lua_Integer limit = luaL_optinteger(L, 2, LUA_MAXINTEGER), validated = 0;
+	FILE *f = fopen(filename, "rb");
+	if (!f) return luaL_error(L, "cannot open %s: %s", filename, strerror(errno));
+	unsigned char *buf = malloc(LOAD_CHUNK_SIZE);
+	size_t n = fread(buf, 1, LOAD_CHUNK_SIZE, f), left = 0;
+	// Look for a byte order mark.
+	const char *encoding = NULL;
+	if (n >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0)
+		encoding = "UTF-8";
+	else if (n >= 2 && (memcmp(buf, "\xFF\xFE", 2) == 0 || memcmp(buf, "\xFE\xFF", 2) == 0))
+		encoding = "UTF-16";
+	// Count NUL bytes in the first chunk. Text in UTF-16 without a byte order mark has many at
+	// either odd (little-endian) or even (big-endian) offsets, and very few at the others.
+	size_t zeroes[2] = {0, 0};
+	for (size_t i = 0; i < n; i++)
+		if (!buf[i]) zeroes[i % 2]++;
+	bool has_zeroes = zeroes[0] || zeroes[1];
+	if (!encoding && has_zeroes && n % 2 == 0 && zeroes[0] * 16 < zeroes[1] && zeroes[1] * 8 >= n / 2)
+		encoding = "UTF-16LE";
+	else if (!encoding && has_zeroes && n % 2 == 0 && zeroes[1] * 16 < zeroes[0] &&
+		zeroes[0] * 8 >= n / 2)
+		encoding = "UTF-16BE";
+	// Otherwise validate the file (or its start) as UTF-8, carrying any incomplete character at
+	// the end of a chunk over to the next one.
+	bool valid = !encoding;
+	while (valid && n > 0) {
+		ptrdiff_t len = utf8_prefix((const char *)buf, left + n);
+		if (!(valid = len >= 0) || (validated += n) >= limit) break;
+		memmove(buf, buf + len, left = left + n - len);
+		n = fread(buf + left, 1, LOAD_CHUNK_SIZE - left, f);
+	}
+	if (valid && (left == 0 || validated >= limit)) encoding = "UTF-8";
+	bool read_error = ferror(f);
+	free(buf), fclose(f);
+	if (read_error) return luaL_error(L, "cannot read %s", filename);
+	return (lua_pushstring(L, encoding), lua_pushboolean(L, has_zeroes), 2);
+}
+
+#define SAVE_CHUNK_SIZE 65536 // number of bytes of buffer text saved at a time
+
+// Writes the given number of bytes from the given buffer to the given file, unless that file
+// is NULL. Returns whether or not all of them were written.
+static bool write_all(FILE *f, const char *buf, size_t len) {
+	return !f || fwrite(buf, 1, len, f) == len;
+}
+
+// Writes the given view's text to the given file in chunks straight from Scintilla's memory,
+// converting them from UTF-8 with the given descriptor unless it is (iconv_t)-1.
+// If the file is NULL, only converts the text. Any incomplete multi-byte character at the end
+// of a chunk is converted with the next chunk.
+// Returns whether or not writing succeeded, and sets *converted to whether or not conversion
+// succeeded.
+static bool write_text(SciObject *view, FILE *f, iconv_t cd, bool *converted) {
+	bool converting = cd != (iconv_t)-1, ok = true;
+	char *out = converting ? malloc(2 * SAVE_CHUNK_SIZE) : NULL, *p = out;
+	if (converting && !out) return (errno = ENOMEM, false);
+	size_t outbytesleft = 2 * SAVE_CHUNK_SIZE;
+	for (sptr_t pos = 0, len = SS(view, SCI_GETLENGTH, 0, 0); ok && *converted && pos < len;) {
+		sptr_t n = len - pos < SAVE_CHUNK_SIZE ? len - pos : SAVE_CHUNK_SIZE;
+		char *inbuf = (char *)SS(view, SCI_GETRANGEPOINTER, pos, n);
+		if (!converting) {
+			ok = write_all(f, inbuf, n), pos += n;
+			continue;
+		}
+		size_t inbytesleft = n;
+		while (ok && iconv(cd, &inbuf, &inbytesleft, &p, &outbytesleft) == (size_t)-1) {
+			if (errno == EINVAL && pos + n < len) break; // incomplete character; convert it next
+			if (!(*converted = errno == E2BIG)) break;
+			ok = write_all(f, out, p - out), p = out, outbytesleft = 2 * SAVE_CHUNK_SIZE;
+		}
+		ok = ok && write_all(f, out, p - out), p = out, outbytesleft = 2 * SAVE_CHUNK_SIZE;
+		pos += n - inbytesleft;
+	}
+	if (ok && *converted && converting) // flush any shift sequence
+		*converted = iconv(cd, NULL, NULL, &p, &outbytesleft) != (size_t)-1,
+		ok = write_all(f, out, p - out);
+	return (free(out), ok);
+}
+
+// `buffer:save_to()` Lua function.
+static int save_to_lua(lua_State *L) {
+	SciObject *view = view_for_doc(L, 1);
+	const char *filename = luaL_checkstring(L, 2), *encoding = luaL_optstring(L, 3, NULL);
+	bool sync = lua_toboolean(L, 4);
+	if (encoding && strcmp(encoding, "UTF-8") == 0) encoding = NULL; // already UTF-8
+	if (encoding && open_iconv(encoding, "UTF-8") == (iconv_t)-1)
+		return luaL_error(L, "invalid encoding(s)");
+#if !_WIN32
+	// Save through symbolic links, and preserve the file's permissions.
+	char *target = realpath(filename, NULL);
+	if (target) filename = lua_pushstring(L, target), free(target);
+	struct stat st;
+	bool exists = stat(filename, &st) == 0;
+	// Write an existing file to a unique temporary file next to it so it can be atomically renamed
+	// over that file with the same owner, group, and permissions. Write the file in place if
+	// it is not a regular file, if it has hard links (which renaming would break), if its
+	// directory is not writable, or if its owner or group cannot be kept.
+	const char *tmp = NULL;
+	FILE *f = NULL;
+	if (exists && S_ISREG(st.st_mode) && st.st_nlink == 1) {
+		const char *name = strrchr(filename, '/');
+		name = name ? name + 1 : filename;
+		size_t size = strlen(filename) + 9; // for '.', ".XXXXXX", and '\0'
+		char *template = malloc(size);
+		snprintf(template, size, "%.*s.%s.XXXXXX", (int)(name - filename), filename, name);
+		int fd = mkstemp(template);
+		if (fd != -1) {
+			tmp = lua_pushstring(L, template);
+			if (fchown(fd, st.st_uid, st.st_gid) == 0 && fchmod(fd, st.st_mode & 07777) == 0)
+				f = fdopen(fd, "wb");
+			if (!f) close(fd), remove(tmp), tmp = NULL;
+		}
+		free(template);
+	}
+#else
+	// Write to a unique temporary file next to the file so it can be atomically renamed over the
+	// file, or write the file in place if that temporary file cannot be created.
+	const char *tmp = NULL, *sep = NULL;
+	FILE *f = NULL;
+	for (const char *c = filename; *c; c++)
+		if (*c == '/' || *c == '\\' || *c == ':') sep = c;
+	char dir[MAX_PATH], path[MAX_PATH];
+	int dir_len = sep ? (int)(sep - filename) + 1 : 0;
+	if (dir_len < MAX_PATH - 14) { // GetTempFileNameA() needs room for the name it creates
+		snprintf(dir, sizeof(dir), "%.*s", dir_len ? dir_len : 1, dir_len ? filename : ".");
+		if (GetTempFileNameA(dir, "ta", 0, path)) {
+			tmp = lua_pushstring(L, path);
+			if (!(f = fopen(tmp, "wb"))) remove(tmp), tmp = NULL;
+		}
+	}
+#endif
+	// Fetch the cached descriptor only now, since the Lua allocations above could run finalizers
+	// that replace it.
+	iconv_t cd = encoding ? open_iconv(encoding, "UTF-8") : (iconv_t)-1;
+	bool converted = true;
+	if (!f && cd != (iconv_t)-1) {
+		// Convert the text without writing it before truncating the file to write it in place so
+		// that a conversion error does not lose the file's contents.
+		write_text(view, NULL, cd, &converted), iconv(cd, NULL, NULL, NULL, NULL); // reset cd
+		if (!converted) return luaL_error(L, "conversion failed");
+	}
+	if (!f && !(f = fopen(filename, "wb"))) return luaL_fileresult(L, 0, filename);
+	bool ok = write_text(view, f, cd, &converted);
+	ok = ok && fflush(f) == 0;
+#if !_WIN32
+	if (ok && sync) ok = fsync(fileno(f)) == 0;
+#else
+	if (ok && sync) ok = _commit(_fileno(f)) == 0;
+#endif
+	ok = fclose(f) == 0 && ok && converted;
+#if !_WIN32
+	ok = ok && (!tmp || rename(tmp, filename) == 0);
+#else
+	if (ok && tmp && !MoveFileExA(tmp, filename, MOVEFILE_REPLACE_EXISTING))
+		ok = false, errno = EACCES;
+#endif
+	if (!ok && tmp) {
+		int error = errno;
+		remove(tmp), errno = error;
+	}
+	if (!ok) {
+		if (!converted) return luaL_error(L, "conversion failed");
+		return luaL_fileresult(L, 0, filename);
+	}
+	return (lua_pushboolean(L, true), 1);
+}
+
+// Returns the number of arguments `call_scintilla()` reads for a Scintilla function with the
+// given parameter and return types.
+static int count_args(int wtype, int ltype, int rtype) {
+	bool warg = wtype >= SINT && wtype <= SSTRING, larg = ltype >= SINT && ltype <= SSTRING;
+	if (wtype == SLEN && ltype == SSTRING) return 1;
+	if (ltype == SSTRINGRET || rtype == SSTRINGRET) return wtype != SLEN && warg;
+	return warg + larg;
+}
+
+// `buffer:batch()` Lua function.
+static int batch(lua_State *L) {
+	luaL_checktype(L, 2, LUA_TTABLE);
+	lua_Integer n = lua_isnoneornil(L, 3) ? luaL_len(L, 2) : luaL_checkinteger(L, 3);
+	for (lua_Integer i = (lua_settop(L, 3), 1); i <= n; lua_settop(L, 3)) {
+		const IfaceEntry *iface = (lua_rawgeti(L, 2, i++), lua_toiface(L, 4));
+		luaL_argcheck(L, iface, 2,
+			lua_pushfstring(L, "unknown Scintilla function or property at index %d", (int)i - 1));
+		int msg = iface->msg, wtype = iface->wtype, ltype = iface->ltype, rtype = iface->rtype;
+		if (iface->property) {
+			msg = iface->set_msg, wtype = iface->wtype, ltype = iface->rtype, rtype = SVOID;
+			luaL_argcheck(L, msg, 2, lua_pushfstring(L, "read-only property at index %d", (int)i - 1));
+			if (ltype == SSTRINGRET) ltype = SSTRING;
+			// Non-indexed property values are passed in wParam, except for strings and margins.
+			if (wtype == SVOID && ltype != SSTRING && msg != SCI_SETMARGINLEFT &&
+				msg != SCI_SETMARGINRIGHT)
+				wtype = ltype, ltype = SVOID;
+		}
+		for (int j = count_args(wtype, ltype, rtype); j > 0; j--) lua_rawgeti(L, 2, i++);
+		// Resolve the view each time since notifications may load other buffers into `dummy_views`.
+		call_scintilla(L, view_for_doc(L, 1), msg, wtype, ltype, rtype, 5);
+	}
+	return 0;
 }
 
+// Bulk range accessor functions available to all buffers, including the command entry.
+static const luaL_Reg range_functions[] = {{"styles_in_range", styles_in_range},
+	{"style_run", style_run}, {"line_states", line_states}, {"fold_levels", fold_levels},
+	{"indicator_ranges", indicator_ranges}, {"text_view", text_view}, {"batch", batch}, {NULL, NULL}};
+
 // Sets the metatable for the value at the given Lua stack index to be the given metatable.
 // Creates the metatable with the given __index and __newindex functions if necessary.
 static void set_metatable(
@@ -435,55 +1426,656 @@ static void set_metatable(
 
 // `buffer[k].__index` metamethod.
 static int property_index(lua_State *L) {
-	bool not_view = (lua_getfield(L, 1, "_self"), !is_type(L, -1, "ta_view"));
-	SciObject *view = not_view ? view_for_doc(L, -1) : lua_toview(L, -1);
-	lua_getfield(L, 1, "_iface"); // {get_id, set_id, rtype, wtype}.
-	int msg = get_int_field(L, -1, 1), wtype = get_int_field(L, -1, 4), ltype = SVOID,
-			rtype = get_int_field(L, -1, 3);
-	luaL_argcheck(L, msg, 2, "write-only property");
-	return (call_scintilla(L, view, msg, wtype, ltype, rtype, 2), 1);
+	Property *prop = lua_touserdata(L, 1);
+	SciObject *view = prop->view ? prop->view : (lua_getiuservalue(L, 1, 1), view_for_doc(L, -1));
+	luaL_argcheck(L, prop->get_id, 2, "write-only property");
+	return (call_scintilla(L, view, prop->get_id, prop->wtype, SVOID, prop->rtype, 2), 1);
 }
 
 // `buffer[k].__newindex` metamethod.
 static int property_newindex(lua_State *L) {
-	bool not_view = (lua_getfield(L, 1, "_self"), !is_type(L, -1, "ta_view"));
-	SciObject *view = not_view ? view_for_doc(L, -1) : lua_toview(L, -1);
-	lua_getfield(L, 1, "_iface"); // {get_id, set_id, rtype, wtype}.
-	int msg = get_int_field(L, -1, 2), wtype = get_int_field(L, -1, 4),
-			ltype = get_int_field(L, -1, 3), rtype = SVOID;
-	luaL_argcheck(L, msg, 3, "read-only property");
-	if (ltype == SSTRINGRET) ltype = SSTRING;
-	return (call_scintilla(L, view, msg, wtype, ltype, rtype, 2), 0);
+	Property *prop = lua_touserdata(L, 1);
+	SciObject *view = prop->view ? prop->view : (lua_getiuservalue(L, 1, 1), view_for_doc(L, -1));
+	luaL_argcheck(L, prop->set_id, 3, "read-only property");
+	return (call_scintilla(L, view, prop->set_id, prop->wtype,
+							prop->rtype != SSTRINGRET ? prop->rtype : SSTRING, SVOID, 2),
+		0);
+}
+
+// Pushes onto the Lua stack the given indexable property for the buffer or view at index 1 and
+// the property name at index 2.
+// Properties are created once per buffer/view and property name, and are cached in the
+// 'properties' registry table, so repeated lookups like `buffer.style_at` do not allocate.
+static void push_property(lua_State *L, const IfaceEntry *iface) {
+	lua_getfield(L, LUA_REGISTRYINDEX, PROPERTIES);
+	if (lua_pushvalue(L, 1), lua_rawget(L, -2) != LUA_TTABLE)
+		lua_pop(L, 1), lua_newtable(L), lua_pushvalue(L, 1), lua_pushvalue(L, -2),
+			lua_rawset(L, -4); // t[self] = {}
+	if (lua_pushvalue(L, 2), lua_rawget(L, -2)) return; // previously looked up property
+	Property *prop = (lua_pop(L, 1), lua_newuserdatauv(L, sizeof(Property), 1));
+	prop->get_id = iface->msg, prop->set_id = iface->set_msg, prop->rtype = iface->rtype,
+	prop->wtype = iface->wtype;
+	prop->view = is_type(L, 1, "ta_view") ? lua_toview(L, 1) : NULL;
+	lua_pushvalue(L, 1), lua_setiuservalue(L, -2, 1);
+	set_metatable(L, -1, "ta_property", property_index, property_newindex);
+	lua_pushvalue(L, 2), lua_pushvalue(L, -2), lua_rawset(L, -4); // t[self][name] = property
 }
 
 // Helper function for `buffer_index()` and `view_index()` that gets Scintilla properties.
-static void get_property(lua_State *L) {
+static void get_property(lua_State *L, const IfaceEntry *iface) {
 	SciObject *view = is_type(L, 1, "ta_buffer") ? view_for_doc(L, 1) : lua_toview(L, 1);
-	// Interface table is of the form {get_id, set_id, rtype, wtype}.
-	int msg = get_int_field(L, -1, 1), wtype = get_int_field(L, -1, 4), ltype = SVOID,
-			rtype = get_int_field(L, -1, 3);
+	int msg = iface->msg, wtype = iface->wtype, ltype = SVOID, rtype = iface->rtype;
 	luaL_argcheck(L, msg || wtype != SVOID, 2, "write-only property");
-	if (wtype != SVOID) { // indexible property
-		// return setmetatable({_self = view, _iface = {...}}, {__index = index, __newindex = newindex})
-		lua_createtable(L, 0, 2);
-		lua_pushvalue(L, 1), lua_setfield(L, -2, "_self");
-		lua_pushvalue(L, -2), lua_setfield(L, -2, "_iface");
-		set_metatable(L, -1, "ta_property", property_index, property_newindex);
-	} else
+	if (wtype != SVOID) // indexible property
+		push_property(L, iface);
+	else
 		call_scintilla(L, view, msg, wtype, ltype, rtype, 2);
 }
 
+// Pushes onto the Lua stack the given Scintilla function's or property's interface table.
+// Function tables are of the form {msg, rtype, wtype, ltype} and property tables are of the
+// form {get_id, set_id, rtype, wtype, 0}.
+static void push_iface_table(lua_State *L, const IfaceEntry *iface) {
+	int n = iface->property ? 5 : 4,
+			fields[] = {iface->msg, iface->property ? iface->set_msg : iface->rtype,
+				iface->property ? iface->rtype : iface->wtype,
+				iface->property ? iface->wtype : iface->ltype, 0};
+	lua_createtable(L, n, 0);
+	for (int i = 0; i < n; i++) lua_pushinteger(L, fields[i]), lua_rawseti(L, -2, i + 1);
+}
+
+// `_SCINTILLA.profile()` Lua function.
+static int profile_lua(lua_State *L) {
+	if ((profiling = lua_isnone(L, 1) || lua_toboolean(L, 1)) && !call_stats)
+		call_stats = calloc(MAX_MESSAGE, sizeof(CallStats));
+	return 0;
+}
+
+// `_SCINTILLA.reset_stats()` Lua function.
+static int reset_stats_lua(lua_State *L) {
+	if (call_stats) memset(call_stats, 0, MAX_MESSAGE * sizeof(CallStats));
+	return 0;
+}
+
+// Call statistics for a Scintilla function, property getter, or property setter.
+typedef struct {
+	const char *name;
+	bool set; // whether or not the statistics are for a property setter
+	const CallStats *stats;
+} CallRecord;
+
+// Comparison function for sorting call records by time, from most time to least time.
+static int compare_records(const void *a, const void *b) {
+	double time_a = ((CallRecord *)a)->stats->time, time_b = ((CallRecord *)b)->stats->time;
+	return time_a < time_b ? 1 : time_a > time_b ? -1 : 0;
+}
+
+// Stores in the given array (which must be large enough for every getter and setter) the call
+// records of the Scintilla messages that have been called, sorted by time, and returns the
+// number of records stored.
+static int get_call_records(CallRecord *records) {
+	int n = 0;
+	for (int i = 0; call_stats && i < IFACE_SIZE; i++) {
+		const IfaceEntry *iface = &iface_entries[i];
+		if (iface->msg > 0 && iface->msg < MAX_MESSAGE && call_stats[iface->msg].calls)
+			records[n++] = (CallRecord){iface->name, false, &call_stats[iface->msg]};
+		if (iface->set_msg > 0 && iface->set_msg < MAX_MESSAGE && call_stats[iface->set_msg].calls)
+			records[n++] = (CallRecord){iface->name, true, &call_stats[iface->set_msg]};
+	}
+	return (qsort(records, n, sizeof(CallRecord), compare_records), n);
+}
+
+// `_SCINTILLA.stats()` Lua function.
+static int stats_lua(lua_State *L) {
+	CallRecord records[2 * IFACE_SIZE];
+	int n = get_call_records(records);
+	lua_createtable(L, n, 0);
+	for (int i = 0; i < n; i++) {
+		lua_createtable(L, 0, 4);
+		lua_pushfstring(L, records[i].set ? "%s=" : "%s", records[i].name),
+			lua_setfield(L, -2, "name");
+		lua_pushinteger(L, records[i].stats->calls), lua_setfield(L, -2, "calls");
+		lua_pushnumber(L, records[i].stats->time), lua_setfield(L, -2, "time");
+		lua_pushinteger(L, records[i].stats->bytes), lua_setfield(L, -2, "bytes");
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+// `_SCINTILLA.dump_stats()` Lua function.
+static int dump_stats_lua(lua_State *L) {
+	const char *filename = luaL_checkstring(L, 1), *ext = strrchr(filename, '.');
+	bool json = ext && strcmp(ext, ".json") == 0;
+	FILE *f = fopen(filename, "w");
+	if (!f) return luaL_fileresult(L, 0, filename);
+	CallRecord records[2 * IFACE_SIZE];
+	int n = get_call_records(records);
+	fputs(json ? "[\n" : "name,calls,time,bytes\n", f);
+	for (int i = 0; i < n; i++)
+		fprintf(f,
+			json ? "\t{\"name\": \"%s%s\", \"calls\": %lld, \"time\": %.9f, \"bytes\": %lld}%s\n" :
+						 "%s%s,%lld,%.9f,%lld%s\n",
+			records[i].name, records[i].set ? "=" : "", (long long)records[i].stats->calls,
+			records[i].stats->time, (long long)records[i].stats->bytes, json && i < n - 1 ? "," : "");
+	if (json) fputs("]\n", f);
+	return luaL_fileresult(L, fclose(f) == 0, filename);
+}
+
+// Returns the modification event mask for views, depending on whether or not `events.MODIFIED`
+// has handlers.
+// Text changes are always notified in order to invalidate text views.
+static int mod_event_mask(void) {
+	bool handled = event_list[SCN_MODIFIED - IFACE_EVENT_BASE].live > 0;
+	return handled ? SC_MODEVENTMASKALL : SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT;
+}
+
+// Updates the modification event mask of all views if the event with the given ID is
+// `events.MODIFIED`.
+static void update_mod_event_mask(lua_State *L, int id) {
+	if (id != SCN_MODIFIED - IFACE_EVENT_BASE) return;
+	lua_getfield(L, LUA_REGISTRYINDEX, VIEWS);
+	for (int i = 1; i <= (int)lua_rawlen(L, -1); i++)
+		SS(lua_toview(L, (lua_rawgeti(L, -1, i), -1)), SCI_SETMODEVENTMASK, mod_event_mask(), 0),
+			lua_pop(L, 1); // pop view
+	lua_pop(L, 1); // pop _VIEWS
+}
+
+// Adds an event with the given name (which may be NULL) and an empty handler table, and returns
+// its ID.
+static int add_event(lua_State *L, const char *name) {
+	if (num_events == max_events)
+		event_list = realloc(event_list, (max_events = fmax(2 * max_events, 64)) * sizeof(Event));
+	int id = num_events++;
+	event_list[id] = (Event){0, 0, NULL, 0, NULL};
+	lua_getfield(L, LUA_REGISTRYINDEX, HANDLERS), lua_newtable(L), lua_rawseti(L, -2, id),
+		lua_pop(L, 1); // pop HANDLERS
+	if (name)
+		lua_getfield(L, LUA_REGISTRYINDEX, EVENT_IDS), lua_pushinteger(L, id),
+			lua_setfield(L, -2, name), lua_pop(L, 1); // pop EVENT_IDS
+	return id;
+}
+
+// Discards all events and their handlers (canceling any in-progress emissions), and adds
+// Scintilla notifications' events.
+static void init_events(lua_State *L) {
+	for (int i = 0; i < num_events; i++) {
+		for (EmitFrame *frame = event_list[i].frames; frame; frame = frame->next) frame->id = -1;
+		free(event_list[i].priorities);
+	}
+	num_events = 0;
+	lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, EVENT_IDS);
+	lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, HANDLERS);
+	lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, EVENT_STATS);
+	for (int i = 0; i < IFACE_EVENT_COUNT; i++) add_event(L, iface_events[i].name);
+	modified_batch_id = add_event(L, "modified_batch"), batch_depth = 0, reset_batch();
+}
+
+// Checks whether the given function argument is an event name, and returns that event's ID,
+// adding the event if necessary.
+static int luaL_checkevent(lua_State *L, int arg) {
+	const char *name = luaL_checkstring(L, arg);
+	int id = event_id(L, name);
+	return id >= 0 ? id : add_event(L, name);
+}
+
+// Checks whether the given function argument is a function or callable table.
+static void luaL_checkhandler(lua_State *L, int arg) {
+	if (lua_type(L, arg) == LUA_TFUNCTION) return;
+	luaL_argexpected(L, luaL_getmetafield(L, arg, "__call") != LUA_TNIL, arg, "function");
+	lua_pop(L, 1); // pop __call
+}
+
+// Pushes onto the Lua stack the handler table of the event with the given ID.
+static void push_handlers(lua_State *L, int id) {
+	lua_getfield(L, LUA_REGISTRYINDEX, HANDLERS), lua_rawgeti(L, -1, id), lua_replace(L, -2);
+}
+
+// Removes disconnected handlers from the handler table of the event with the given ID, unless
+// that event is being emitted.
+static void compact_handlers(lua_State *L, int id) {
+	Event *event = &event_list[id];
+	if (event->frames || event->live == event->len) return;
+	push_handlers(L, id);
+	int n = 0;
+	for (int i = 1; i <= event->len; i++)
+		if (lua_rawgeti(L, -1, i), lua_toboolean(L, -1))
+			// handlers[n] = f, handlers[f] = n
+			lua_pushvalue(L, -1), lua_rawseti(L, -3, ++n), lua_pushinteger(L, n), lua_rawset(L, -3),
+				event->priorities[n - 1] = event->priorities[i - 1];
+		else
+			lua_pop(L, 1); // pop false
+	for (int i = n + 1; i <= event->len; i++) lua_pushnil(L), lua_rawseti(L, -2, i);
+	event->len = n, lua_pop(L, 1); // pop handlers
+}
+
+// Disconnects the handler at the given stack index from the event with the given ID, if it
+// is connected.
+// Disconnected handlers are marked `false` in order to keep handler indices stable.
+static void disconnect_handler(lua_State *L, int id, int index) {
+	push_handlers(L, id);
+	if (lua_pushvalue(L, index), lua_rawget(L, -2) == LUA_TNUMBER) {
+		lua_pushboolean(L, false), lua_rawseti(L, -3, lua_tointeger(L, -2)); // handlers[i] = false
+		lua_pushvalue(L, index), lua_pushnil(L), lua_rawset(L, -4); // handlers[f] = nil
+		if (--event_list[id].live == 0) update_mod_event_mask(L, id);
+	}
+	lua_pop(L, 2); // pop index, handlers
+}
+
+// Returns the handler index a handler with the given priority should be inserted at for the
+// given event, which is after all handlers with the same or higher priorities.
+// Since priorities are in descending order (including those of disconnected handlers), a
+// binary search suffices.
+static int priority_index(Event *event, int priority) {
+	int lo = 0, hi = event->len;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (event->priorities[mid] >= priority)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo + 1;
+}
+
+// `events.connect()` Lua function.
+static int connect_lua(lua_State *L) {
+	int id = luaL_checkevent(L, 1), index = (luaL_checkhandler(L, 2), 0), priority = 0, isnum;
+	bool indexed = lua_type(L, 3) == LUA_TNUMBER;
+	if (indexed)
+		index = luaL_checkinteger(L, 3);
+	else if (lua_istable(L, 3)) {
+		priority = (lua_getfield(L, 3, "priority"), lua_tointegerx(L, -1, &isnum));
+		luaL_argcheck(L, isnum || lua_isnil(L, -1), 3, "priority must be an integer"), lua_pop(L, 1);
+	} else
+		luaL_argexpected(L, lua_isnoneornil(L, 3), 3, "number or table");
+	disconnect_handler(L, id, 2), compact_handlers(L, id); // in case it already exists
+	Event *event = &event_list[id];
+	luaL_argcheck(L, !indexed || (index >= 1 && index <= event->live + 1), 3,
+		"position out of bounds");
+	push_handlers(L, id);
+	// Find the handler index of the index-th connected handler, if any, or the index for the
+	// given priority. An indexed handler takes the priority of the handler it is inserted before,
+	// or of the last connected handler if it is appended, in order to keep priorities ordered.
+	int pos = indexed ? event->len + 1 : priority_index(event, priority);
+	if (indexed) priority = 0;
+	for (int i = 1, n = 0; indexed && i <= event->len; i++) {
+		bool connected = (lua_rawgeti(L, -1, i), lua_toboolean(L, -1));
+		if (lua_pop(L, 1), !connected) continue;
+		priority = event->priorities[i - 1];
+		if (++n == index) {
+			pos = i;
+			break;
+		}
+	}
+	// Shift the handler at that index and subsequent ones up by one.
+	if (event->len == event->size)
+		event->priorities =
+			realloc(event->priorities, (event->size = fmax(2 * event->size, 8)) * sizeof(int));
+	memmove(&event->priorities[pos], &event->priorities[pos - 1],
+		(event->len - pos + 1) * sizeof(int));
+	event->priorities[pos - 1] = priority;
+	for (int i = event->len; i >= pos; i--)
+		if (lua_rawgeti(L, -1, i), lua_pushvalue(L, -1), lua_rawseti(L, -3, i + 1), // handlers[i + 1]
+			lua_toboolean(L, -1))
+			lua_pushinteger(L, i + 1), lua_rawset(L, -3); // handlers[f] = i + 1
+		else
+			lua_pop(L, 1); // pop false
+	for (EmitFrame *frame = event->frames; frame; frame = frame->next)
+		if (frame->i >= pos) frame->i++;
+	lua_pushvalue(L, 2), lua_rawseti(L, -2, pos); // handlers[pos] = f
+	lua_pushvalue(L, 2), lua_pushinteger(L, pos), lua_rawset(L, -3); // handlers[f] = pos
+	if (event->len++, ++event->live == 1) update_mod_event_mask(L, id);
+	return 0;
+}
+
+// `events.disconnect()` Lua function.
+static int disconnect_lua(lua_State *L) {
+	int id = (luaL_checkhandler(L, 2), event_id(L, luaL_checkstring(L, 1)));
+	if (id >= 0) disconnect_handler(L, id, 2);
+	return 0;
+}
+
+// `events.handlers()` Lua function.
+static int handlers_lua(lua_State *L) {
+	int id = event_id(L, luaL_checkstring(L, 1));
+	lua_newtable(L), lua_newtable(L); // handlers, priorities
+	if (id < 0) return 2;
+	push_handlers(L, id);
+	for (int i = 1, n = 0; i <= event_list[id].len; i++)
+		if (lua_rawgeti(L, -1, i), lua_toboolean(L, -1))
+			lua_rawseti(L, -4, ++n), lua_pushinteger(L, event_list[id].priorities[i - 1]),
+				lua_rawseti(L, -3, n);
+		else
+			lua_pop(L, 1); // pop false
+	return (lua_pop(L, 1), 2); // pop event handlers
+}
+
+// Returns the number of bytes currently allocated by Lua.
+static lua_Integer gc_bytes(lua_State *L) {
+	return (lua_Integer)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+// Records a call to the handler below the call's result on the Lua stack for the event with
+// the given ID. The call started at the given time with the given number of bytes allocated.
+static void record_handler(lua_State *L, int id, double start, lua_Integer bytes) {
+	double time = now() - start;
+	bytes = gc_bytes(L) - bytes; // may be negative if garbage was collected
+	lua_getfield(L, LUA_REGISTRYINDEX, EVENT_STATS);
+	if (lua_rawgeti(L, -1, id) != LUA_TTABLE)
+		lua_pop(L, 1), lua_newtable(L), lua_pushvalue(L, -1), lua_rawseti(L, -3, id);
+	HandlerStats *stats = (lua_pushvalue(L, -4), lua_rawget(L, -2), lua_touserdata(L, -1));
+	if (!stats)
+		lua_pop(L, 1), stats = lua_newuserdatauv(L, sizeof(HandlerStats), 0),
+									 memset(stats, 0, sizeof(HandlerStats)), lua_pushvalue(L, -5),
+									 lua_pushvalue(L, -2), lua_rawset(L, -4); // stats[f] = ud
+	stats->calls++, stats->time += time, stats->bytes += bytes > 0 ? bytes : 0;
+	if (time > stats->max_time) stats->max_time = time;
+	lua_pop(L, 3); // pop stats, event stats, EVENT_STATS
+}
+
+// Calls, in order, the handlers of the emission given as a light userdata argument, passing
+// them the remaining arguments, and returns the first non-nil value returned by a handler.
+// Handler errors are not caught, so they end the emission.
+static int call_handlers(lua_State *L) {
+	EmitFrame *frame = lua_touserdata(L, 1);
+	int handlers = (push_handlers(L, frame->id), lua_gettop(L));
+	for (; frame->id >= 0 && frame->i <= event_list[frame->id].len; frame->i++) {
+		if (lua_rawgeti(L, handlers, frame->i), !lua_toboolean(L, -1)) {
+			lua_pop(L, 1); // pop disconnected handler
+			continue;
+		}
+		bool profile = profiling_events;
+		if (profile) lua_pushvalue(L, -1); // keep the handler for recording
+		for (int i = 2; i < handlers; i++) lua_pushvalue(L, i);
+		double start = profile ? now() : 0;
+		lua_Integer bytes = profile ? gc_bytes(L) : 0;
+		lua_call(L, frame->nargs, 1);
+		if (profile) record_handler(L, frame->id, start, bytes), lua_remove(L, -2); // pop handler
+		if (!lua_isnil(L, -1)) return 1;
+		lua_pop(L, 1); // pop nil
+	}
+	return 0;
+}
+
+// `events.profile()` Lua function.
+static int profile_events_lua(lua_State *L) {
+	return (profiling_events = lua_isnoneornil(L, 1) || lua_toboolean(L, 1), 0);
+}
+
+// Writes to the trace file the event about to be emitted, whose name and arguments are the
+// given number of values at the top of the given Lua stack, unless a handler of a recorded
+// event is emitting it.
+// Values other than booleans, numbers, and strings (e.g. buffers) are recorded as nil.
+static void record_event(lua_State *L, int n) {
+	if (emit_depth < record_depth) record_depth = emit_depth; // e.g. recording started in a handler
+	if (emit_depth > record_depth) return;
+	double time = now() - trace_start;
+	fwrite(&time, sizeof(double), 1, trace), fputc(n, trace);
+	for (int i = lua_gettop(L) - n + 1; i <= lua_gettop(L); i++) {
+		int type = lua_type(L, i);
+		if (type != LUA_TBOOLEAN && type != LUA_TNUMBER && type != LUA_TSTRING) type = LUA_TNIL;
+		if (type == LUA_TNUMBER && !lua_isinteger(L, i)) type = TRACE_TFLOAT;
+		fputc(type, trace);
+		if (type == LUA_TBOOLEAN)
+			fputc(lua_toboolean(L, i), trace);
+		else if (type == LUA_TNUMBER) {
+			int64_t value = lua_tointeger(L, i);
+			fwrite(&value, sizeof(int64_t), 1, trace);
+		} else if (type == TRACE_TFLOAT) {
+			double value = lua_tonumber(L, i);
+			fwrite(&value, sizeof(double), 1, trace);
+		} else if (type == LUA_TSTRING) {
+			size_t len;
+			const char *s = lua_tolstring(L, i, &len);
+			uint32_t len32 = len;
+			fwrite(&len32, sizeof(uint32_t), 1, trace), fwrite(s, 1, len, trace);
+		}
+	}
+}
+
+// Reads a value from the given trace file and pushes it onto the Lua stack, returning whether
+// or not that was successful.
+static bool read_trace_value(lua_State *L, FILE *f) {
+	int type = fgetc(f);
+	if (type == LUA_TNIL) return (lua_pushnil(L), true);
+	if (type == LUA_TBOOLEAN) {
+		int value = fgetc(f);
+		return value != EOF && (lua_pushboolean(L, value), true);
+	} else if (type == LUA_TNUMBER) {
+		int64_t value;
+		return fread(&value, sizeof(int64_t), 1, f) == 1 && (lua_pushinteger(L, value), true);
+	} else if (type == TRACE_TFLOAT) {
+		double value;
+		return fread(&value, sizeof(double), 1, f) == 1 && (lua_pushnumber(L, value), true);
+	} else if (type == LUA_TSTRING) {
+		// Read the string a buffer at a time so a corrupt length fails at the end of the file
+		// instead of allocating up to 4GB.
+		uint32_t len;
+		if (fread(&len, sizeof(uint32_t), 1, f) != 1) return false;
+		luaL_Buffer buf;
+		luaL_buffinit(L, &buf);
+		while (len > 0) {
+			size_t n = len < LUAL_BUFFERSIZE ? len : LUAL_BUFFERSIZE;
+			if (fread(luaL_prepbuffer(&buf), 1, n, f) != n) return false;
+			luaL_addsize(&buf, n), len -= n;
+		}
+		return (luaL_pushresult(&buf), true);
+	}
+	return false;
+}
+
+// `events.record()` Lua function.
+static int record_lua(lua_State *L) {
+	if (trace) fclose(trace), trace = NULL;
+	if (lua_isnoneornil(L, 1)) return 0;
+	const char *filename = luaL_checkstring(L, 1);
+	if (!(trace = fopen(filename, "wb"))) return luaL_fileresult(L, 0, filename);
+	fputs(TRACE_MAGIC, trace), trace_start = now(), record_depth = emit_depth;
+	return (lua_pushboolean(L, true), 1);
+}
+
+// Comparison function for sorting latencies from least to most.
+static int compare_latencies(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// `events.replay()` Lua function.
+static int replay_lua(lua_State *L) {
+	const char *filename = luaL_checkstring(L, 1);
+	FILE *f = fopen(filename, "rb");
+	if (!f) return luaL_fileresult(L, 0, filename);
+	char magic[sizeof(TRACE_MAGIC) - 1];
+	if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+		memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+		return (fclose(f), luaL_error(L, "invalid trace file '%s'", filename));
+	// Emit each recorded event as fast as possible, collecting latencies by event name.
+	// Like the platform, forward unhandled keys to Scintilla, and start sampling keystroke
+	// latencies. Only live notifications finish samples, since recorded ones did not happen now.
+	// Skip startup and shutdown events, as well as recorded notifications that a forwarded key
+	// already made Scintilla emit again.
+	lua_settop(L, 1), lua_newtable(L); // latencies
+	double time;
+	int n;
+	bool skip_forwarded = false;
+	while (fread(&time, sizeof(double), 1, f) == 1 && (n = fgetc(f)) > 0) {
+		if (!lua_checkstack(L, n + 4)) return (fclose(f), luaL_error(L, "trace record too large"));
+		lua_settop(L, 2), lua_getglobal(L, "events"), lua_getfield(L, -1, "emit");
+		bool ok = true;
+		for (int i = 0; ok && i < n; i++) ok = read_trace_value(L, f);
+		if (!ok || lua_type(L, -n) != LUA_TSTRING) break; // truncated or corrupt
+		const char *name = lua_tostring(L, -n);
+		if (strcmp(name, "initialized") == 0 || strcmp(name, "quit") == 0) continue;
+		bool key = strcmp(name, "key") == 0 && n >= 3;
+		int code = key ? lua_tointeger(L, -n + 1) : 0, modifiers = key ? lua_tointeger(L, -n + 2) : 0;
+		int id = event_id(L, name);
+		bool notification = id >= 0 && id < IFACE_EVENT_COUNT;
+		if (notification && skip_forwarded && forwarded_notifications[id]) continue;
+		if (!notification) skip_forwarded = false;
+		if (trace) record_event(L, n); // e.g. recording a replay
+		lua_pushvalue(L, -n), lua_insert(L, 3); // keep the event name for recording latency
+		double start = now();
+		int status = (emit_depth++, lua_pcall(L, n, 1, 0));
+		if (emit_depth--, status != LUA_OK) return (fclose(f), lua_error(L));
+		if (key) key_emitted(start);
+		if (key && !lua_toboolean(L, -1)) {
+			memset(forwarded_notifications, 0, sizeof(forwarded_notifications));
+			forwarding_key = true;
+			send_key(is_command_entry_active() ? command_entry : focused_view, code, modifiers);
+			forwarding_key = false, skip_forwarded = true;
+		}
+		double latency = now() - start;
+		lua_pop(L, 2); // pop result, events
+		if (lua_pushvalue(L, 3), lua_rawget(L, 2) != LUA_TTABLE)
+			lua_pop(L, 1), lua_newtable(L), lua_pushvalue(L, 3), lua_pushvalue(L, -2), lua_rawset(L, 2);
+		lua_pushnumber(L, latency), lua_rawseti(L, -2, lua_rawlen(L, -2) + 1);
+		lua_pop(L, 2); // pop latencies list, event name
+	}
+	fclose(f), lua_settop(L, 2);
+	// Summarize latencies.
+	lua_newtable(L);
+	for (lua_pushnil(L); lua_next(L, 2); lua_pop(L, 1)) {
+		int len = lua_rawlen(L, -1);
+		double *latencies = malloc(len * sizeof(double));
+		for (int i = 0; i < len; i++)
+			latencies[i] = (lua_rawgeti(L, -1, i + 1), lua_tonumber(L, -1)), lua_pop(L, 1);
+		qsort(latencies, len, sizeof(double), compare_latencies);
+		lua_createtable(L, 0, 5);
+		lua_pushinteger(L, len), lua_setfield(L, -2, "count");
+		lua_pushnumber(L, latencies[len / 2]), lua_setfield(L, -2, "p50");
+		lua_pushnumber(L, latencies[(int)(len * 0.9)]), lua_setfield(L, -2, "p90");
+		lua_pushnumber(L, latencies[(int)(len * 0.99)]), lua_setfield(L, -2, "p99");
+		lua_pushnumber(L, latencies[len - 1]), lua_setfield(L, -2, "max");
+		lua_pushvalue(L, -3), lua_insert(L, -2), lua_rawset(L, 3), free(latencies);
+	}
+	return 1;
+}
+
+// `events.reset_stats()` Lua function.
+static int reset_event_stats_lua(lua_State *L) {
+	return (lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, EVENT_STATS), 0);
+}
+
+// Comparison function for sorting `events.stats()` by time, from most to least.
+static int compare_event_stats(lua_State *L) {
+	lua_getfield(L, 1, "time"), lua_getfield(L, 2, "time");
+	return (lua_pushboolean(L, lua_tonumber(L, -2) > lua_tonumber(L, -1)), 1);
+}
+
+// `events.stats()` Lua function.
+static int event_stats_lua(lua_State *L) {
+	lua_newtable(L), lua_getfield(L, LUA_REGISTRYINDEX, EVENT_STATS);
+	lua_getfield(L, LUA_REGISTRYINDEX, EVENT_IDS);
+	for (lua_pushnil(L); lua_next(L, -2); lua_pop(L, 1)) {
+		if (lua_rawgeti(L, -4, lua_tointeger(L, -1)) != LUA_TTABLE) {
+			lua_pop(L, 1); // pop nil
+			continue;
+		}
+		for (lua_pushnil(L); lua_next(L, -2); lua_pop(L, 1)) {
+			HandlerStats *stats = lua_touserdata(L, -1);
+			lua_createtable(L, 0, 6);
+			lua_pushvalue(L, -6), lua_setfield(L, -2, "event");
+			if (lua_type(L, -3) == LUA_TFUNCTION) {
+				lua_Debug ar;
+				lua_pushvalue(L, -3), lua_getinfo(L, ">S", &ar);
+				lua_pushfstring(L, "%s:%d", ar.short_src, ar.linedefined);
+			} else
+				lua_pushliteral(L, "?"); // callable table
+			lua_setfield(L, -2, "handler");
+			lua_pushinteger(L, stats->calls), lua_setfield(L, -2, "calls");
+			lua_pushnumber(L, stats->time), lua_setfield(L, -2, "time");
+			lua_pushnumber(L, stats->max_time), lua_setfield(L, -2, "max_time");
+			lua_pushinteger(L, stats->bytes), lua_setfield(L, -2, "bytes");
+			lua_rawseti(L, -9, lua_rawlen(L, -9) + 1);
+		}
+		lua_pop(L, 1); // pop event stats
+	}
+	lua_pop(L, 2); // pop EVENT_IDS, EVENT_STATS
+	lua_getglobal(L, "table"), lua_getfield(L, -1, "sort"), lua_pushvalue(L, -3),
+		lua_pushcfunction(L, compare_event_stats), lua_call(L, 2, 0);
+	return (lua_pop(L, 1), 1); // pop table
+}
+
+// `events.batch()` Lua function.
+static int batch_lua(lua_State *L) {
+	luaL_checkhandler(L, 1), lua_settop(L, 1), batch_depth++;
+	begin_batch(SS(focused_view, SCI_GETDOCPOINTER, 0, 0));
+	int status = lua_pcall(L, 0, LUA_MULTRET, 0);
+	if (batch_depth--, status != LUA_OK) reset_batch();
+	end_batch();
+	return status == LUA_OK ? lua_gettop(L) : lua_error(L);
+}
+
+static bool error_emitted; // prevents infinite loops when error handlers themselves error
+
+// `events.emit()` Lua function.
+// Calls all handlers in a single protected call. If a handler errors, emits `events.ERROR`
+// with the error and returns it.
+static int emit_lua(lua_State *L) {
+	int id = event_id(L, luaL_checkstring(L, 1)), nargs = lua_gettop(L) - 1;
+	if (id < 0 || event_list[id].live == 0) return 0;
+	compact_handlers(L, id);
+	EmitFrame frame = {id, 1, nargs, event_list[id].frames};
+	lua_pushcfunction(L, call_handlers), lua_pushlightuserdata(L, &frame), lua_rotate(L, 2, 2);
+	event_list[id].frames = &frame;
+	int status = lua_pcall(L, nargs + 1, 1, 0);
+	if (event_list[id].frames == &frame) event_list[id].frames = frame.next; // unless reset
+	if (status == LUA_OK) return 1;
+	if (!error_emitted) {
+		error_emitted = true;
+		lua_pushcfunction(L, emit_lua), lua_pushliteral(L, "error"), lua_pushvalue(L, -3),
+			lua_call(L, 2, 0);
+		error_emitted = false;
+	} else
+		// io.stderr:write(error)
+		lua_getglobal(L, "io"), lua_getfield(L, -1, "stderr"), lua_getfield(L, -1, "write"),
+			lua_insert(L, -2), lua_pushvalue(L, -4), lua_call(L, 2, 0), lua_pop(L, 1); // pop io
+	return 1;
+}
+
+// `_SCINTILLA.__index` metamethod.
+// Scintilla functions and properties live in C, so only create their interface tables on demand.
+static int iface_index(lua_State *L) {
+	const IfaceEntry *iface = lua_toiface(L, 2);
+	return (iface ? push_iface_table(L, iface) : lua_pushnil(L), 1);
+}
+
+// `_SCINTILLA.__pairs` iterator function.
+// Iterates over constants and events first, and then over Scintilla functions and properties.
+static int iface_next(lua_State *L) {
+	const IfaceEntry *iface = lua_toiface(L, 2);
+	if (!iface && (lua_settop(L, 2), lua_next(L, 1))) return 2; // constant or event
+	int i = iface ? iface - iface_entries + 1 : 0;
+	if (i == IFACE_SIZE) return (lua_pushnil(L), 1);
+	return (lua_pushstring(L, iface_entries[i].name), push_iface_table(L, &iface_entries[i]), 2);
+}
+
+// `_SCINTILLA.__pairs` metamethod.
+static int iface_pairs(lua_State *L) {
+	return (lua_pushcfunction(L, iface_next), lua_pushvalue(L, 1), lua_pushnil(L), 3);
+}
+
+// Helper function for `buffer_index()` and `view_index()` that pushes onto the Lua stack the
+// Scintilla function, property value, or constant whose name is at index 2, and returns
+// whether or not there is one.
+static bool push_scintilla(lua_State *L) {
+	const IfaceEntry *iface;
+	if (lua_getfield(L, LUA_REGISTRYINDEX, FUNCTIONS), lua_pushvalue(L, 2), lua_rawget(L, -2))
+		return true; // previously looked up Scintilla function
+	// If the key is a Scintilla function, return a callable closure.
+	// If the key is a Scintilla property, determine if it is an indexible one or not. If so,
+	// return a table with the appropriate metatable; otherwise call Scintilla to get the
+	// property's value.
+	if ((iface = lua_toiface(L, 2)))
+		return (!iface->property ? push_function(L, lua_gettop(L) - 1, iface) :
+															 get_property(L, iface),
+			true);
+	return lua_getglobal(L, "_SCINTILLA"), lua_pushvalue(L, 2), lua_rawget(L, -2); // constant
+}
+
 // `buffer.__index` metamethod.
 static int buffer_index(lua_State *L) {
-	if (lua_getglobal(L, "_SCINTILLA"), lua_pushvalue(L, 2), lua_rawget(L, -2)) {
-		if (lua_type(L, -1) != LUA_TTABLE) return 1; // constant
-		// If the key is a Scintilla function (4 iface values), return a callable closure.
-		// If the key is a Scintilla property, determine if it is an indexible one or not. If so,
-		// return a table with the appropriate metatable; otherwise call Scintilla to get the
-		// property's value.
-		return (
-			lua_rawlen(L, -1) == 4 ? lua_pushcclosure(L, call_scintilla_lua, 1) : get_property(L), 1);
-	}
+	if (push_scintilla(L)) return 1;
 	if (strcmp(lua_tostring(L, 2), "tab_label") == 0 &&
 		lua_todoc(L, 1) != SS(command_entry, SCI_GETDOCPOINTER, 0, 0))
 		return luaL_argerror(L, 3, "write-only property");
@@ -495,11 +2087,9 @@ static int buffer_index(lua_State *L) {
 }
 
 // Helper function for `buffer_newindex()` and `view_newindex()` that sets Scintilla properties.
-static void set_property(lua_State *L) {
+static void set_property(lua_State *L, const IfaceEntry *iface) {
 	SciObject *view = is_type(L, 1, "ta_buffer") ? view_for_doc(L, 1) : lua_toview(L, 1);
-	// Interface table is of the form {get_id, set_id, wtype, ltype}.
-	int msg = get_int_field(L, -1, 2), wtype = get_int_field(L, -1, 3),
-			ltype = get_int_field(L, -1, 4), rtype = SVOID, temp;
+	int msg = iface->set_msg, wtype = iface->rtype, ltype = iface->wtype, rtype = SVOID, temp;
 	luaL_argcheck(L, msg && ltype == SVOID, 3, "read-only property");
 	if (wtype == SSTRING || wtype == SSTRINGRET || msg == SCI_SETMARGINLEFT ||
 		msg == SCI_SETMARGINRIGHT)
@@ -509,16 +2099,12 @@ static void set_property(lua_State *L) {
 
 // `buffer.__newindex` metamethod.
 static int buffer_newindex(lua_State *L) {
-	// If the key is a Scintilla property (more than 4 iface values), call Scintilla to set its value.
-	if (lua_getglobal(L, "_SCINTILLA"), lua_pushvalue(L, 2),
-		lua_rawget(L, -2) == LUA_TTABLE && lua_rawlen(L, -1) > 4)
-		return (set_property(L), 0);
+	const IfaceEntry *iface;
+	// If the key is a Scintilla property, call Scintilla to set its value.
+	if ((iface = lua_toiface(L, 2)) && iface->property) return (set_property(L, iface), 0);
 	if (strcmp(lua_tostring(L, 2), "tab_label") == 0 &&
 		lua_todoc(L, 1) != SS(command_entry, SCI_GETDOCPOINTER, 0, 0))
-		return (set_tab_label((lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_pushvalue(L, 1),
-														lua_gettable(L, -2), lua_tointeger(L, -1) - 1),
-							luaL_checkstring(L, 3)),
-			0);
+		return (set_tab_label(doc_index(lua_todoc(L, 1)) - 1, luaL_checkstring(L, 3)), 0);
 	if (strcmp(lua_tostring(L, 2), "label") == 0 && is_command_entry(lua_todoc(L, 1)))
 		return (set_command_entry_label(luaL_checkstring(L, 3)), 0);
 	if (strcmp(lua_tostring(L, 2), "height") == 0 && is_command_entry(lua_todoc(L, 1)))
@@ -655,6 +2241,36 @@ static int update_ui_lua(lua_State *L) { return (update_ui(), 0); }
 // `ui.suspend()` Lua function.
 static int suspend_lua(lua_State *L) { return (suspend(), 0); }
 
+// `ui.latency_stats()` Lua function.
+static int latency_stats_lua(lua_State *L) {
+	int len = num_key_latencies;
+	double totals[MAX_KEY_LATENCIES], lua_time = 0, scintilla_time = 0, redraw_time = 0;
+	int histogram[8] = {0}; // under 1, 2, 4, 8, 16, 32, and 64 ms, and the rest
+	for (int i = 0; i < len; i++) {
+		KeyLatency *latency = &key_latencies[i];
+		totals[i] = latency->total, lua_time += latency->lua, scintilla_time += latency->scintilla,
+		redraw_time += latency->redraw;
+		int bucket = 0;
+		for (double ms = 1; bucket < 7 && latency->total * 1000 >= ms; ms *= 2) bucket++;
+		histogram[bucket]++;
+	}
+	qsort(totals, len, sizeof(double), compare_latencies);
+	lua_createtable(L, 0, 9);
+	lua_pushinteger(L, len), lua_setfield(L, -2, "count");
+	lua_pushnumber(L, len ? totals[len / 2] : 0), lua_setfield(L, -2, "p50");
+	lua_pushnumber(L, len ? totals[(int)(len * 0.9)] : 0), lua_setfield(L, -2, "p90");
+	lua_pushnumber(L, len ? totals[(int)(len * 0.99)] : 0), lua_setfield(L, -2, "p99");
+	lua_pushnumber(L, len ? totals[len - 1] : 0), lua_setfield(L, -2, "max");
+	lua_pushnumber(L, len ? lua_time / len : 0), lua_setfield(L, -2, "lua");
+	lua_pushnumber(L, len ? scintilla_time / len : 0), lua_setfield(L, -2, "scintilla");
+	lua_pushnumber(L, len ? redraw_time / len : 0), lua_setfield(L, -2, "redraw");
+	lua_createtable(L, 8, 0);
+	for (int i = 0; i < 8; i++) lua_pushinteger(L, histogram[i]), lua_rawseti(L, -2, i + 1);
+	lua_setfield(L, -2, "histogram");
+	if (lua_toboolean(L, 1)) num_key_latencies = key_latency_index = 0, key_time = 0; // reset
+	return 1;
+}
+
 // `ui.__index` Lua metamethod.
 static int ui_index(lua_State *L) {
 	const char *key = lua_tostring(L, 2);
@@ -673,6 +2289,8 @@ static int ui_index(lua_State *L) {
 	}
 	if (strcmp(key, "tabs") == 0)
 		return (tabs <= 1 ? lua_pushboolean(L, tabs) : lua_pushinteger(L, tabs), 1);
+	if (strcmp(key, "buffer_views") == 0) return (lua_pushinteger(L, num_dummy_views), 1);
+	if (strcmp(key, "buffer_view_rebinds") == 0) return (lua_pushinteger(L, dummy_view_rebinds), 1);
 	return (lua_rawget(L, 1), 1);
 }
 
@@ -700,8 +2318,16 @@ static int ui_newindex(lua_State *L) {
 	}
 	if (strcmp(key, "tabs") == 0)
 		return (show_tabs((tabs = !lua_isinteger(L, 3) ? lua_toboolean(L, 3) : lua_tointeger(L, 3)) &&
-							((lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_rawlen(L, -1)) > 1 || tabs > 1)),
+							(num_docs > 1 || tabs > 1)),
 			0);
+	if (strcmp(key, "buffer_views") == 0) {
+		int n = luaL_checkinteger(L, 3);
+		luaL_argcheck(L, n > 0 && n <= MAX_DUMMY_VIEWS, 3, "number of views out of range");
+		for (int i = n; i < MAX_DUMMY_VIEWS && dummy_views[i]; i++)
+			delete_scintilla(dummy_views[i]), dummy_views[i] = NULL;
+		return (num_dummy_views = n, 0);
+	}
+	if (strcmp(key, "buffer_view_rebinds") == 0) return luaL_argerror(L, 2, "read-only property");
 	return (lua_rawset(L, 1), 0);
 }
 
@@ -715,15 +2341,20 @@ void move_buffer(int from, int to, bool reorder_tabs) {
 	// for i = 1, #_BUFFERS do _BUFFERS[_BUFFERS[i]] = i end
 	for (size_t i = 1; i <= lua_rawlen(lua, -1); i++)
 		lua_rawgeti(lua, -1, i), lua_pushinteger(lua, i), lua_rawset(lua, -3);
+	DocEntry entry = docs[from - 1];
+	if (from < to)
+		memmove(&docs[from - 1], &docs[from], (to - from) * sizeof(DocEntry));
+	else
+		memmove(&docs[to], &docs[to - 1], (from - to) * sizeof(DocEntry));
+	docs[to - 1] = entry, rehash_docs();
 	if (lua_pop(lua, 1), reorder_tabs) move_tab(from - 1, to - 1); // pop _BUFFERS
 }
 
 // `_G.move_buffer` Lua function.
 static int move_buffer_lua(lua_State *L) {
 	int from = luaL_checkinteger(L, 1), to = luaL_checkinteger(L, 2);
-	lua_getfield(lua, LUA_REGISTRYINDEX, BUFFERS);
-	luaL_argcheck(L, from >= 1 && (size_t)from <= lua_rawlen(L, -1), 1, "position out of bounds");
-	luaL_argcheck(L, to >= 1 && (size_t)to <= lua_rawlen(L, -1), 2, "position out of bounds");
+	luaL_argcheck(L, from >= 1 && from <= num_docs, 1, "position out of bounds");
+	luaL_argcheck(L, to >= 1 && to <= num_docs, 2, "position out of bounds");
 	return (move_buffer(from, to, true), 0);
 }
 
@@ -795,6 +2426,10 @@ static bool init_lua(int argc, char **argv) {
 		lua_setfield(L, LUA_REGISTRYINDEX, ARG);
 		lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, BUFFERS);
 		lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, VIEWS);
+		lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, FUNCTIONS);
+		lua_newtable(L); // properties of collected buffers and views should be collected too
+		lua_createtable(L, 0, 1), lua_pushliteral(L, "k"), lua_setfield(L, -2, "__mode"),
+			lua_setmetatable(L, -2), lua_setfield(L, LUA_REGISTRYINDEX, PROPERTIES);
 	} else {
 		// Clear package.loaded and _G.
 		lua_getfield(L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
@@ -808,6 +2443,12 @@ static bool init_lua(int argc, char **argv) {
 	luaL_requiref(L, "lpeg", luaopen_lpeg, 1), lua_pop(L, 1);
 	luaL_requiref(L, "lfs", luaopen_lfs, 1), lua_pop(L, 1);
 	luaL_requiref(L, "regex", luaopen_regex, 1), lua_pop(L, 1);
+	lua_getglobal(L, "string"), lua_pushcfunction(L, iconv_lua), lua_setfield(L, -2, "iconv"),
+		lua_pushcfunction(L, iconv_stream_lua), lua_setfield(L, -2, "iconv_stream"),
+		lua_pushcfunction(L, utf8_valid_lua), lua_setfield(L, -2, "utf8_valid"),
+		lua_pushcfunction(L, utf8_count_lua), lua_setfield(L, -2, "utf8_count"),
+		lua_pushcfunction(L, find_byte_lua), lua_setfield(L, -2, "find_byte"),
+		lua_pop(L, 1); // string.iconv, etc.
 
 	// Check for invoking Textadept as a Lua interpreter.
 	for (int i = 0; i < argc; i++)
@@ -826,10 +2467,33 @@ static bool init_lua(int argc, char **argv) {
 			return (lua_close(L), lua = NULL, exit_status = ok ? 0 : 1, false);
 		}
 
-	lua_getglobal(L, "string"), lua_pushcfunction(L, iconv_lua), lua_setfield(L, -2, "iconv"),
-		lua_pop(L, 1); // string.iconv
+	lua_newtable(L), lua_newtable(L); // _SCINTILLA, its metatable
+	lua_pushcfunction(L, iface_index), lua_setfield(L, -2, "__index");
+	lua_pushcfunction(L, iface_pairs), lua_setfield(L, -2, "__pairs");
+	lua_setmetatable(L, -2); // constants and events are added by core/iface.lua
+	lua_pushcfunction(L, profile_lua), lua_setfield(L, -2, "profile");
+	lua_pushcfunction(L, stats_lua), lua_setfield(L, -2, "stats");
+	lua_pushcfunction(L, reset_stats_lua), lua_setfield(L, -2, "reset_stats");
+	lua_pushcfunction(L, dump_stats_lua), lua_setfield(L, -2, "dump_stats");
+	lua_setglobal(L, "_SCINTILLA");
+	init_events(L), lua_newtable(L); // events
+	lua_pushcfunction(L, connect_lua), lua_setfield(L, -2, "connect");
+	lua_pushcfunction(L, disconnect_lua), lua_setfield(L, -2, "disconnect");
+	lua_pushcfunction(L, handlers_lua), lua_setfield(L, -2, "handlers");
+	lua_pushcfunction(L, emit_lua), lua_setfield(L, -2, "emit");
+	lua_pushcfunction(L, batch_lua), lua_setfield(L, -2, "batch");
+	lua_pushcfunction(L, profile_events_lua), lua_setfield(L, -2, "profile");
+	lua_pushcfunction(L, event_stats_lua), lua_setfield(L, -2, "stats");
+	lua_pushcfunction(L, reset_event_stats_lua), lua_setfield(L, -2, "reset_stats");
+	lua_pushcfunction(L, record_lua), lua_setfield(L, -2, "record");
+	lua_pushcfunction(L, replay_lua), lua_setfield(L, -2, "replay");
+	lua_setglobal(L, "events"); // event constants are added by core/events.lua
 	lua_getglobal(L, "os"), lua_pushcfunction(L, spawn_lua), lua_setfield(L, -2, "spawn"),
 		lua_pop(L, 1); // os.spawn
+	lua_getglobal(L, "io"), lua_pushcfunction(L, load_into_lua), lua_setfield(L, -2, "load_into"),
+		lua_pushcfunction(L, loader_lua), lua_setfield(L, -2, "loader"),
+		lua_pushcfunction(L, detect_encoding_lua), lua_setfield(L, -2, "detect_encoding"),
+		lua_pop(L, 1); // io.load_into, io.loader, io.detect_encoding
 
 	lua_newtable(L), lua_newtable(L); // ui, ui.find
 	lua_pushcfunction(L, click_find_next), lua_setfield(L, -2, "find_next");
@@ -860,6 +2524,7 @@ static bool init_lua(int argc, char **argv) {
 	lua_pushcfunction(L, popup_menu_lua), lua_setfield(L, -2, "popup_menu");
 	lua_pushcfunction(L, update_ui_lua), lua_setfield(L, -2, "update");
 	lua_pushcfunction(L, suspend_lua), lua_setfield(L, -2, "suspend");
+	lua_pushcfunction(L, latency_stats_lua), lua_setfield(L, -2, "latency_stats");
 	set_metatable(L, -1, "ta_ui", ui_index, ui_newindex), lua_setglobal(L, "ui");
 
 	// _G
@@ -882,12 +2547,7 @@ static bool init_lua(int argc, char **argv) {
 }
 
 // Synchronizes the tabbar after switching between Scintilla views or documents.
-static void sync_tabbar(void) {
-	set_tab((lua_getfield(lua, LUA_REGISTRYINDEX, BUFFERS),
-		lua_pushdoc(lua, SS(focused_view, SCI_GETDOCPOINTER, 0, 0)), lua_gettable(lua, -2),
-		lua_replace(lua, -2), lua_tointeger(lua, -1) - 1)), // _BUFFERS[buffer]
-		lua_pop(lua, 1); // pop index
-}
+static void sync_tabbar(void) { set_tab(doc_index(SS(focused_view, SCI_GETDOCPOINTER, 0, 0)) - 1); }
 
 // Signal that focus has changed to the given Scintilla view.
 // Generates 'view_before_switch' and 'view_after_switch' events.
@@ -898,40 +2558,53 @@ static void view_focused(SciObject *view) {
 	if (!initing && !closing) emit("view_after_switch", -1);
 }
 
-// Emits the given Scintilla notification to Lua.
+// Emits the given Scintilla notification to Lua as its named event (e.g. `events.UPDATE_UI`).
 static void emit_notification(SCNotification *n) {
 	if (n->nmhdr.code == SCN_KEY) return; // platforms are handling key events; avoid duplicates
-	lua_newtable(lua);
-	lua_pushinteger(lua, n->nmhdr.code), lua_setfield(lua, -2, "code");
-	lua_pushinteger(lua, n->position + 1), lua_setfield(lua, -2, "position");
-	lua_pushinteger(lua, n->ch), lua_setfield(lua, -2, "ch");
-	lua_pushinteger(lua, n->modifiers), lua_setfield(lua, -2, "modifiers");
-	lua_pushinteger(lua, n->modificationType), lua_setfield(lua, -2, "modification_type");
-	if (n->text)
-		lua_pushlstring(lua, n->text, n->length ? (size_t)n->length : strlen(n->text)),
-			lua_setfield(lua, -2, "text");
-	lua_pushinteger(lua, n->length), lua_setfield(lua, -2, "length");
-	lua_pushinteger(lua, n->linesAdded), lua_setfield(lua, -2, "lines_added");
-	// lua_pushinteger(lua, n->message), lua_setfield(lua, -2, "message");
-	// lua_pushinteger(lua, n->wParam), lua_setfield(lua, -2, "wParam");
-	// lua_pushinteger(lua, n->lParam), lua_setfield(lua, -2, "lParam");
-	lua_pushinteger(lua, n->line + 1), lua_setfield(lua, -2, "line");
-	// lua_pushinteger(lua, n->foldLevelNow), lua_setfield(lua, -2, "fold_level_now");
-	// lua_pushinteger(lua, n->foldLevelPrev), lua_setfield(lua, -2, "fold_level_prev");
-	lua_pushinteger(lua, n->margin + 1), lua_setfield(lua, -2, "margin");
-	lua_pushinteger(lua, n->listType), lua_setfield(lua, -2, "list_type");
-	lua_pushinteger(lua, n->x), lua_setfield(lua, -2, "x");
-	lua_pushinteger(lua, n->y), lua_setfield(lua, -2, "y");
-	// lua_pushinteger(lua, n->token), lua_setfield(lua, -2, "token");
-	// lua_pushinteger(lua, n->annotationLinesAdded), lua_setfield(lua, -2, "annotation_lines_added");
-	lua_pushinteger(lua, n->updated), lua_setfield(lua, -2, "updated");
-	// lua_pushinteger(lua, n->listCompletionMethod), lua_setfield(lua, -2, "list_completion_method");
-	// lua_pushinteger(lua, n->characterSource), lua_setfield(lua, -2, "character_source");
-	emit("SCN", LUA_TTABLE, luaL_ref(lua, LUA_REGISTRYINDEX), -1);
+	unsigned int i = n->nmhdr.code - IFACE_EVENT_BASE;
+	if (forwarding_key && i < IFACE_EVENT_COUNT) forwarded_notifications[i] = true;
+	if (i >= IFACE_EVENT_COUNT || event_list[i].live == 0 || !push_emit(iface_events[i].name)) return;
+	// Push the notification's fields as event arguments in the order the event expects them.
+	int nargs = 1;
+	for (const int *field = iface_events[i].fields; *field; field++, nargs++) switch (*field) {
+		case NOTIFY_ANNOTATION_LINES_ADDED: lua_pushinteger(lua, n->annotationLinesAdded); break;
+		case NOTIFY_CH: lua_pushinteger(lua, n->ch); break;
+		case NOTIFY_CHARACTER_SOURCE: lua_pushinteger(lua, n->characterSource); break;
+		case NOTIFY_FOLD_LEVEL_NOW: lua_pushinteger(lua, n->foldLevelNow); break;
+		case NOTIFY_FOLD_LEVEL_PREV: lua_pushinteger(lua, n->foldLevelPrev); break;
+		case NOTIFY_L_PARAM: lua_pushinteger(lua, n->lParam); break;
+		case NOTIFY_LENGTH: lua_pushinteger(lua, n->length); break;
+		case NOTIFY_LINE: lua_pushinteger(lua, n->line + 1); break;
+		case NOTIFY_LINES_ADDED: lua_pushinteger(lua, n->linesAdded); break;
+		case NOTIFY_LIST_COMPLETION_METHOD: lua_pushinteger(lua, n->listCompletionMethod); break;
+		case NOTIFY_LIST_TYPE: lua_pushinteger(lua, n->listType); break;
+		case NOTIFY_MARGIN: lua_pushinteger(lua, n->margin + 1); break;
+		case NOTIFY_MESSAGE: lua_pushinteger(lua, n->message); break;
+		case NOTIFY_MODIFICATION_TYPE: lua_pushinteger(lua, n->modificationType); break;
+		case NOTIFY_MODIFIERS: lua_pushinteger(lua, n->modifiers); break;
+		case NOTIFY_POSITION: lua_pushinteger(lua, n->position + 1); break;
+		case NOTIFY_TEXT:
+			if (n->text)
+				lua_pushlstring(lua, n->text, n->length ? (size_t)n->length : strlen(n->text));
+			else
+				lua_pushnil(lua);
+			break;
+		case NOTIFY_TOKEN: lua_pushinteger(lua, n->token); break;
+		case NOTIFY_UPDATED: lua_pushinteger(lua, n->updated); break;
+		case NOTIFY_W_PARAM: lua_pushinteger(lua, n->wParam); break;
+		case NOTIFY_X: lua_pushinteger(lua, n->x); break;
+		case NOTIFY_Y: lua_pushinteger(lua, n->y); break;
+		default: lua_pushnil(lua);
+		}
+	call_emit(nargs);
 }
 
 // Signal for a Scintilla notification.
 static void notified(SciObject *view, int _, SCNotification *n, void *__) {
+	if (key_time > 0) key_notified(n->nmhdr.code);
+	if (n->nmhdr.code == SCN_MODIFIED &&
+		(n->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)))
+		text_version++; // invalidate text views
 	if (n->nmhdr.code == SCN_STYLENEEDED)
 		emit("style_needed", LUA_TNUMBER, n->position + 1, LUA_TTABLE,
 			(lua_pushdoc(lua, SS(view, SCI_GETDOCPOINTER, 0, 0)), luaL_ref(lua, LUA_REGISTRYINDEX)), -1);
@@ -943,6 +2616,7 @@ static void notified(SciObject *view, int _, SCNotification *n, void *__) {
 			emit("key", LUA_TNUMBER, SCK_ESCAPE, LUA_TNUMBER, 0, -1);
 	} else if (view == focused_view || n->nmhdr.code == SCN_URIDROPPED) {
 		if (view != focused_view) view_focused(view);
+		if (n->nmhdr.code == SCN_MODIFIED) batch_modification(SS(view, SCI_GETDOCPOINTER, 0, 0), n);
 		emit_notification(n);
 	} else if (n->nmhdr.code == SCN_FOCUSIN)
 		view_focused(view);
@@ -952,32 +2626,28 @@ static void notified(SciObject *view, int _, SCNotification *n, void *__) {
 // An absolute value of -1 represents the last document.
 static void goto_doc(lua_State *L, SciObject *view, int n, bool relative) {
 	if (relative && n == 0) return;
-	lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS);
-	if (relative) {
-		// i = _BUFFERS[buffer], i = (i + n) % #_BUFFERS, _BUFFERS[i]
-		int i = (lua_pushdoc(L, SS(view, SCI_GETDOCPOINTER, 0, 0)), lua_gettable(L, -2),
-			lua_tointeger(L, -1));
-		if (lua_pop(L, 1), (i = (i + n) % lua_rawlen(L, -1)) == 0) i = lua_rawlen(L, -1); // pop index
-		lua_rawgeti(L, -1, i), lua_replace(L, -2);
-	} else
-		lua_rawgeti(L, -1, n > 0 ? n : (int)lua_rawlen(L, -1)), lua_replace(L, -2);
-	luaL_argcheck(L, !lua_isnil(L, -1), 2, "no Buffer exists at that index");
-	SS(view, SCI_SETDOCPOINTER, 0, lua_todoc(L, -1)), lua_setglobal(L, "buffer"), sync_tabbar();
-}
-
-// Adds to Lua either a newly created Scintilla document, or the first Scintilla view's
-// preexisting document.
+	int i = n > 0 || relative ? n : num_docs;
+	if (relative && (i = (doc_index(SS(view, SCI_GETDOCPOINTER, 0, 0)) + n) % num_docs) == 0)
+		i = num_docs;
+	luaL_argcheck(L, i >= 1 && i <= num_docs, 2, "no Buffer exists at that index");
+	if (view == focused_view && SS(view, SCI_GETDOCPOINTER, 0, 0) != docs[i - 1].doc)
+		reset_batch(), docs[i - 1].undo_depth = 0; // only batch modifications in the current buffer
+	SS(view, SCI_SETDOCPOINTER, 0, docs[i - 1].doc), lua_pushdoc(L, docs[i - 1].doc),
+		lua_setglobal(L, "buffer"), sync_tabbar();
+}
+
+// Adds to Lua either a newly created Scintilla document with the given document options,
+// or the first Scintilla view's preexisting document.
 // Generates 'buffer_before_switch' and 'buffer_new' events.
-static void new_buffer(sptr_t doc) {
+static void new_buffer(sptr_t doc, int options) {
 	if (!doc) {
 		emit("buffer_before_switch", -1);
-		add_doc(doc = SS(focused_view, SCI_CREATEDOCUMENT, 0, 0));
+		add_doc(doc = SS(focused_view, SCI_CREATEDOCUMENT, 0, options));
 		goto_doc(lua, focused_view, -1, false);
 	} else
 		add_doc(doc), SS(focused_view, SCI_ADDREFDOCUMENT, 0, doc);
 	lua_pushdoc(lua, doc), lua_setglobal(lua, "buffer");
-	int n = (lua_getfield(lua, LUA_REGISTRYINDEX, BUFFERS), lua_rawlen(lua, -1));
-	add_tab(), show_tabs(tabs && ((lua_pop(lua, 1), n) > 1 || tabs > 1)); // pop _BUFFERS
+	add_tab(), show_tabs(tabs && (num_docs > 1 || tabs > 1));
 	if (!initing) emit("buffer_new", -1);
 }
 
@@ -991,23 +2661,23 @@ static void remove_doc(sptr_t doc) {
 	for (lua_pushnil(lua); lua_next(lua, -2); lua_pop(lua, 1))
 		if (lua_isnumber(lua, -2) && doc == SS(lua_toview(lua, -1), SCI_GETDOCPOINTER, 0, 0))
 			goto_doc(lua, lua_toview(lua, -1), -1, true);
-	if (doc == SS(dummy_view, SCI_GETDOCPOINTER, 0, 0)) SS(dummy_view, SCI_SETDOCPOINTER, 0, 0);
+	if (doc == batch_doc) reset_batch();
+	unload_dummy_doc(doc);
 	lua_getfield(lua, LUA_REGISTRYINDEX, BUFFERS), lua_replace(lua, -2); // replaces _VIEWS
-	for (size_t i = 1; i <= lua_rawlen(lua, -1); lua_pop(lua, 1), i++)
-		if (doc == (lua_rawgeti(lua, -1, i), lua_todoc(lua, -1))) { // popped on loop
-			// _BUFFERS[buffer] = nil, _BUFFERS[buffer.doc_pointer] = nil, table.remove(_BUFFERS, i)
-			lua_pushnil(lua), lua_rawset(lua, -3);
-			lua_pushnil(lua), lua_rawsetp(lua, -2, (sptr_t *)doc);
-			lua_getglobal(lua, "table"), lua_getfield(lua, -1, "remove"), lua_replace(lua, -2),
-				lua_pushvalue(lua, -2), lua_pushinteger(lua, i), lua_call(lua, 2, !closing ? 1 : 0);
-			// Save the removed buffer for use in the 'buffer_deleted' event (remove its metatable first).
-			if (!closing) lua_pushnil(lua), lua_setmetatable(lua, -2), lua_insert(lua, -2);
-			// for j = 1, #_BUFFERS do _BUFFERS[_BUFFERS[j]] = j end
-			for (size_t j = 1; j <= lua_rawlen(lua, -1); j++)
-				lua_rawgeti(lua, -1, j), lua_pushinteger(lua, j), lua_rawset(lua, -3);
-			remove_tab(i - 1), show_tabs(tabs && (lua_rawlen(lua, -1) > 1 || tabs > 1));
-			break;
-		}
+	int i = doc_index(doc);
+	// _BUFFERS[buffer] = nil, _BUFFERS[buffer.doc_pointer] = nil, table.remove(_BUFFERS, i)
+	lua_pushdoc(lua, doc), lua_pushnil(lua), lua_rawset(lua, -3);
+	lua_pushnil(lua), lua_rawsetp(lua, -2, (sptr_t *)doc);
+	lua_getglobal(lua, "table"), lua_getfield(lua, -1, "remove"), lua_replace(lua, -2),
+		lua_pushvalue(lua, -2), lua_pushinteger(lua, i), lua_call(lua, 2, !closing ? 1 : 0);
+	// Save the removed buffer for use in the 'buffer_deleted' event (remove its metatable first).
+	if (!closing) lua_pushnil(lua), lua_setmetatable(lua, -2), lua_insert(lua, -2);
+	// for j = 1, #_BUFFERS do _BUFFERS[_BUFFERS[j]] = j end
+	for (size_t j = 1; j <= lua_rawlen(lua, -1); j++)
+		lua_rawgeti(lua, -1, j), lua_pushinteger(lua, j), lua_rawset(lua, -3);
+	luaL_unref(lua, LUA_REGISTRYINDEX, docs[i - 1].ref);
+	memmove(&docs[i - 1], &docs[i], (num_docs - i) * sizeof(DocEntry)), num_docs--, rehash_docs();
+	remove_tab(i - 1), show_tabs(tabs && (num_docs > 1 || tabs > 1));
 	lua_pop(lua, 1); // pop _BUFFERS
 	if (!closing) emit("buffer_deleted", LUA_TTABLE, luaL_ref(lua, LUA_REGISTRYINDEX), -1);
 }
@@ -1022,7 +2692,7 @@ static int delete_buffer_lua(lua_State *L) {
 	SciObject *view = view_for_doc(L, 1);
 	luaL_argcheck(L, view != command_entry, 1, "cannot delete command entry");
 	sptr_t doc = SS(view, SCI_GETDOCPOINTER, 0, 0);
-	if (lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_rawlen(L, -1) == 1) new_buffer(0);
+	if (num_docs == 1) new_buffer(0, 0);
 	if (view == focused_view) goto_doc(L, focused_view, -1, true);
 	delete_buffer(doc);
 	if (view == focused_view) emit("buffer_after_switch", -1);
@@ -1032,8 +2702,10 @@ static int delete_buffer_lua(lua_State *L) {
 // `_G.buffer_new()` Lua function.
 static int new_buffer_lua(lua_State *L) {
 	if (initing) return luaL_error(L, "cannot create buffers during initialization");
-	new_buffer(0);
-	return (lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_rawgeti(L, -1, lua_rawlen(L, -1)), 1);
+	// Large documents can hold more than 2GB of text and do not allocate memory for styles.
+	bool large = lua_toboolean(L, lua_istable(L, 1) ? 2 : 1); // buffer.new() or buffer:new()
+	new_buffer(0, large ? SC_DOCUMENTOPTION_TEXT_LARGE | SC_DOCUMENTOPTION_STYLES_NONE : 0);
+	return (lua_pushdoc(L, docs[num_docs - 1].doc), 1);
 }
 
 // Adds the given Scintilla document along with a metatable to the 'buffers' Lua registry table.
@@ -1045,17 +2717,31 @@ static void add_doc(sptr_t doc) {
 		lua_pushlightuserdata(lua, (sptr_t *)doc), lua_setfield(lua, -2, "doc_pointer");
 		lua_pushcfunction(lua, delete_buffer_lua), lua_setfield(lua, -2, "delete");
 		lua_pushcfunction(lua, new_buffer_lua), lua_setfield(lua, -2, "new");
+		lua_pushcfunction(lua, save_to_lua), lua_setfield(lua, -2, "save_to");
 		set_metatable(lua, -1, "ta_buffer", buffer_index, buffer_newindex);
 	} else
 		lua_getglobal(lua, "ui"), lua_getfield(lua, -1, "command_entry"), lua_replace(lua, -2),
 			lua_pushstring(lua, "doc_pointer"),
 			lua_pushlightuserdata(lua, (sptr_t *)SS(command_entry, SCI_GETDOCPOINTER, 0, 0)),
 			lua_rawset(lua, -3); // ui.command_entry.doc_pointer = doc
+	for (const luaL_Reg *f = range_functions; f->name; f++)
+		lua_pushstring(lua, f->name), lua_pushcfunction(lua, f->func), lua_rawset(lua, -3);
 	// t[buffer.doc_pointer] = buffer, t[doc and #t + 1 or 0] = buffer, t[buffer] = doc and #t or 0
 	lua_getfield(lua, -1, "doc_pointer"), lua_pushvalue(lua, -2), lua_rawset(lua, -4);
 	lua_pushvalue(lua, -1), lua_rawseti(lua, -3, doc ? lua_rawlen(lua, -3) + 1 : 0);
+	int ref = (lua_pushvalue(lua, -1), luaL_ref(lua, LUA_REGISTRYINDEX));
 	lua_pushinteger(lua, doc ? lua_rawlen(lua, -2) : 0), lua_rawset(lua, -3);
 	lua_pop(lua, 1); // pop _BUFFERS
+	if (doc) {
+		if (num_docs == max_docs)
+			docs = realloc(docs, (max_docs = max_docs ? 2 * max_docs : 16) * sizeof(DocEntry));
+		docs[num_docs++] = (DocEntry){doc, ref, 0};
+		if (num_doc_indices < 2 * num_docs)
+			rehash_docs();
+		else
+			doc_indices[doc_slot(doc)] = num_docs;
+	} else
+		command_entry_ref = ref;
 }
 
 // `view.goto_buffer()` Lua function.
@@ -1063,9 +2749,9 @@ static int goto_doc_lua(lua_State *L) {
 	SciObject *view = luaL_checkview(L, 1), *prev_view = focused_view;
 	bool relative = lua_isnumber(L, 2);
 	if (!relative)
-		lua_getfield(L, LUA_REGISTRYINDEX, BUFFERS), lua_pushvalue(L, 2), lua_gettable(L, -2),
-			lua_replace(L, 2), // i = _BUFFERS[buffer]
-			luaL_argcheck(L, lua_isnumber(L, 2), 2, "Buffer or relative index expected");
+		luaL_argcheck(L, is_type(L, 2, "ta_buffer") && doc_index(lua_todoc(L, 2)), 2,
+			"Buffer or relative index expected"),
+			lua_pushinteger(L, doc_index(lua_todoc(L, 2))), lua_replace(L, 2);
 	// If the indexed view is not currently focused, temporarily focus it so `_G.buffer` in
 	// handlers is accurate.
 	if (view != focused_view) focus_view(view);
@@ -1125,20 +2811,13 @@ static int view_index(lua_State *L) {
 		PaneInfo info = get_pane_info_from_view(lua_toview(L, 1));
 		return (info.is_split ? lua_pushinteger(L, info.size) : lua_pushnil(L), 1);
 	}
-	if (lua_getglobal(L, "_SCINTILLA"), lua_pushvalue(L, 2), lua_rawget(L, -2)) {
-		if (lua_type(L, -1) != LUA_TTABLE) return 1; // constant or function
-		// If the key is a Scintilla function (4 iface values), return a callable closure.
-		// If the key is a Scintilla property, determine if it is an indexible one or not. If so,
-		// return a table with the appropriate metatable; otherwise call Scintilla to get the
-		// property's value.
-		return (
-			lua_rawlen(L, -1) == 4 ? lua_pushcclosure(L, call_scintilla_lua, 1) : get_property(L), 1);
-	}
+	if (push_scintilla(L)) return 1;
 	return (lua_settop(L, 2), lua_rawget(L, 1), 1);
 }
 
 // `view.__newindex` metamethod.
 static int view_newindex(lua_State *L) {
+	const IfaceEntry *iface;
 	if (strcmp(lua_tostring(L, 2), "buffer") == 0)
 		return (luaL_argerror(L, 2, "read-only property"), 0);
 	if (strcmp(lua_tostring(L, 2), "size") == 0) {
@@ -1146,10 +2825,8 @@ static int view_newindex(lua_State *L) {
 		if (info.is_split) set_pane_size(info.self, fmax(luaL_checkinteger(L, 3), 0));
 		return 0;
 	}
-	// If the key is a Scintilla property (more than 4 iface values), call Scintilla to set its value.
-	if (lua_getglobal(L, "_SCINTILLA"), lua_pushvalue(L, 2),
-		lua_rawget(L, -2) == LUA_TTABLE && lua_rawlen(L, -1) > 4)
-		return (set_property(L), 0);
+	// If the key is a Scintilla property, call Scintilla to set its value.
+	if ((iface = lua_toiface(L, 2)) && iface->property) return (set_property(L, iface), 0);
 	return (lua_settop(L, 3), lua_rawset(L, 1), 0);
 }
 
@@ -1175,11 +2852,11 @@ static void add_view(SciObject *view) {
 // Generates a 'view_new' event.
 static SciObject *new_view(sptr_t doc) {
 	SciObject *view = new_scintilla(notified);
-	SS(view, SCI_USEPOPUP, SC_POPUP_NEVER, 0);
+	SS(view, SCI_USEPOPUP, SC_POPUP_NEVER, 0), SS(view, SCI_SETMODEVENTMASK, mod_event_mask(), 0);
 	add_view(view), lua_pushview(lua, view), lua_setglobal(lua, "view");
 	if (doc) SS(view, SCI_SETDOCPOINTER, 0, doc);
 	focus_view(view), focused_view = view;
-	if (!doc) new_buffer(SS(view, SCI_GETDOCPOINTER, 0, 0));
+	if (!doc) new_buffer(SS(view, SCI_GETDOCPOINTER, 0, 0), 0);
 	if (!initing) emit("view_new", -1);
 	return view;
 }
@@ -1191,11 +2868,20 @@ void close_textadept(void) {
 	if (lua) {
 		closing = true;
 		while (unsplit_view(focused_view, delete_view)) {}
-		lua_getfield(lua, LUA_REGISTRYINDEX, BUFFERS);
-		for (int i = lua_rawlen(lua, -1); i > 0; lua_pop(lua, 1), i--)
-			lua_rawgeti(lua, -1, i), delete_buffer(lua_todoc(lua, -1)); // popped on loop
-		delete_scintilla(focused_view), delete_scintilla(command_entry), delete_scintilla(dummy_view);
+		while (num_docs > 0) delete_buffer(docs[num_docs - 1].doc);
+		delete_scintilla(focused_view), delete_scintilla(command_entry);
+		for (int i = 0; i < MAX_DUMMY_VIEWS && dummy_views[i]; i++)
+			delete_scintilla(dummy_views[i]), dummy_views[i] = NULL;
 		lua_close(lua), lua = NULL;
+		free(docs), docs = NULL, num_docs = max_docs = 0, command_entry_ref = LUA_NOREF;
+		free(doc_indices), doc_indices = NULL, num_doc_indices = 0;
+		for (int i = 0; i < num_events; i++) free(event_list[i].priorities);
+		free(event_list), event_list = NULL, num_events = max_events = 0;
+		for (int i = 0; i < ICONV_CACHE_SIZE && iconv_cache[i].to; i++)
+			free(iconv_cache[i].to), free(iconv_cache[i].from), iconv_close(iconv_cache[i].cd),
+				iconv_cache[i].to = NULL;
+		iconv_cache_next = 0;
+		if (trace) fclose(trace), trace = NULL;
 	}
 	if (textadept_home) free(textadept_home), textadept_home = NULL;
 }
@@ -1241,7 +2927,6 @@ bool init_textadept(int argc, char **argv) {
 	bool ok = init_lua(argc, argv);
 	if (!ok) return (close_textadept(), ok); // exit_status has been set
 	command_entry = new_scintilla(notified), add_doc(0);
-	dummy_view = new_scintilla(notified), SS(dummy_view, SCI_SETMODEVENTMASK, SC_MOD_NONE, 0);
 	initing = true, new_window(create_first_view), ok = run_file("init.lua"), initing = false;
 	if (!ok) return (close_textadept(), exit_status = 1, ok);
 	emit("buffer_new", -1), emit("view_new", -1); // first ones
@@ -2,6 +2,7 @@
 // Curses platform for Textadept.
 
 #include "textadept.h"
+#include "simd.h"
 
 #include "lauxlib.h"
 #include "ScintillaCurses.h"
@@ -121,6 +122,10 @@ void focus_view(SciObject *view) {
 	SS(view, SCI_SETFOCUS, 1, 0);
 }
 
+void send_key(SciObject *view, int code, int modifiers) {
+	scintilla_send_key(view, code, modifiers);
+}
+
 sptr_t SS(SciObject *view, int message, uptr_t wparam, sptr_t lparam) {
 	return scintilla_send_message(view, message, wparam, lparam);
 }
@@ -382,7 +387,8 @@ bool is_find_active(void) { return findbox != NULL; }
 // Resizes and repositions the command entry, taking label width into account.
 static void resize_command_entry(void) {
 	WINDOW *win = scintilla_get_window(command_entry);
-	int height = get_command_entry_height(), label_width = utf8strlen(command_entry_label);
+	int height = get_command_entry_height(),
+			label_width = utf8_count(command_entry_label, strlen(command_entry_label));
 	wresize(win, height, COLS - label_width), mvwin(win, LINES - 1 - height, label_width);
 }
 
@@ -401,7 +407,7 @@ int get_command_entry_height(void) { return getmaxy(scintilla_get_window(command
 
 void set_command_entry_height(int height) {
 	WINDOW *win = scintilla_get_window(command_entry);
-	int label_width = utf8strlen(command_entry_label);
+	int label_width = utf8_count(command_entry_label, strlen(command_entry_label));
 	wresize(win, height, COLS - label_width), mvwin(win, LINES - 1 - height, label_width);
 }
 
@@ -409,7 +415,7 @@ void set_statusbar_text(int bar, const char *text) {
 	int start = bar == 0 ? 0 : statusbar_length[0];
 	int end = bar == 0 ? COLS - statusbar_length[1] : COLS;
 	for (int i = start; i < end; i++) mvaddch(LINES - 1, i, ' '); // clear
-	int len = (int)utf8strlen(text);
+	int len = (int)utf8_count(text, strlen(text));
 	mvaddstr(LINES - 1, bar == 0 ? 0 : COLS - len, text), refresh();
 	statusbar_length[bar] = len;
 }
@@ -720,9 +726,10 @@ int list_dialog(DialogOptions opts, lua_State *L) {
 	size_t *column_widths = malloc(num_columns * sizeof(size_t)), row_len = 0;
 	for (int i = 1; i <= num_columns; i++) {
 		const char *column = opts.columns ? (lua_rawgeti(L, opts.columns, i), lua_tostring(L, -1)) : "";
-		size_t utf8max = utf8strlen(column), max_diff = strlen(column) - utf8max;
+		size_t len = strlen(column), utf8max = utf8_count(column, len), max_diff = len - utf8max;
 		for (int j = i - 1; j < num_items; j += num_columns) {
-			size_t utf8len = utf8strlen(items[j]), diff = strlen(items[j]) - utf8len;
+			size_t item_len = strlen(items[j]), utf8len = utf8_count(items[j], item_len),
+						 diff = item_len - utf8len;
 			if (utf8len > utf8max) utf8max = utf8len;
 			if (diff > max_diff) max_diff = diff;
 		}
@@ -740,7 +747,7 @@ int list_dialog(DialogOptions opts, lua_State *L) {
 				(opts.columns ? (lua_rawgeti(L, opts.columns, j - i + 1), lua_tostring(L, -1)) : "") :
 				items[j];
 			p = strcpy(p, item) + strlen(item);
-			size_t padding = column_widths[j - i] - utf8strlen(item);
+			size_t padding = column_widths[j - i] - utf8_count(item, strlen(item));
 			while (padding-- > 0) *p++ = ' ';
 			*p++ = (i < 0) ? '|' : ' ';
 			if (i < 0 && opts.columns) lua_pop(L, 1); // pop header
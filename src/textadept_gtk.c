@@ -208,9 +208,12 @@ void get_size(int *width, int *height) { gtk_window_get_size(GTK_WINDOW(window),
 
 void set_size(int width, int height) { gtk_window_resize(GTK_WINDOW(window), width, height); }
 
+static bool sending_key; // whether or not `send_key()` is sending an already emitted keypress
+
 // Signal for a Scintilla keypress.
 // Note: cannot use bool return value due to modern i686-w64-mingw32-gcc issue.
 static int keypress(GtkWidget *_, GdkEventKey *event, void *__) {
+	if (sending_key) return false; // let Scintilla handle it
 	int modifiers = (event->state & GDK_SHIFT_MASK ? SCMOD_SHIFT : 0) |
 		(event->state & GDK_CONTROL_MASK ? SCMOD_CTRL : 0) |
 		(event->state & GDK_MOD1_MASK ? SCMOD_ALT : 0) |
@@ -224,8 +227,18 @@ static bool mouse_clicked(GtkWidget *w, GdkEventButton *event, void *_) {
 	return (show_context_menu("context_menu", event), true);
 }
 
+// The view `SS()` last sent a message to, along with that view's Scintilla direct function
+// and pointer. Sending messages directly bypasses GTK's type-checked widget casts.
+static SciObject *direct_view;
+static SciFnDirect direct_function;
+static sptr_t direct_pointer;
+
 SciObject *new_scintilla(void (*notified)(SciObject *, int, SCNotification *, void *)) {
 	SciObject *view = scintilla_new();
+	g_object_set_data(G_OBJECT(view), "direct_function",
+		(void *)scintilla_send_message(SCINTILLA(view), SCI_GETDIRECTFUNCTION, 0, 0));
+	g_object_set_data(G_OBJECT(view), "direct_pointer",
+		(void *)scintilla_send_message(SCINTILLA(view), SCI_GETDIRECTPOINTER, 0, 0));
 	if (notified) g_signal_connect(view, SCINTILLA_NOTIFY, G_CALLBACK(notified), NULL);
 	g_signal_connect(view, "key-press-event", G_CALLBACK(keypress), NULL);
 	g_signal_connect(view, "button-press-event", G_CALLBACK(mouse_clicked), NULL);
@@ -234,8 +247,27 @@ SciObject *new_scintilla(void (*notified)(SciObject *, int, SCNotification *, vo
 
 void focus_view(SciObject *view) { gtk_widget_grab_focus(view), update_ui(); }
 
+void send_key(SciObject *view, int code, int modifiers) {
+	GdkEvent *event = gdk_event_new(GDK_KEY_PRESS);
+	event->key.window = g_object_ref(gtk_widget_get_window(view)), event->key.send_event = true;
+	event->key.time = GDK_CURRENT_TIME, event->key.keyval = code;
+	event->key.state = (modifiers & SCMOD_SHIFT ? GDK_SHIFT_MASK : 0) |
+		(modifiers & SCMOD_CTRL ? GDK_CONTROL_MASK : 0) | (modifiers & SCMOD_ALT ? GDK_MOD1_MASK : 0) |
+		(modifiers & SCMOD_META ? GDK_META_MASK : 0);
+#if GTK_CHECK_VERSION(3, 20, 0)
+	gdk_event_set_device(
+		event, gdk_seat_get_keyboard(gdk_display_get_default_seat(gdk_display_get_default())));
+#endif
+	sending_key = true, gtk_widget_event(view, event), sending_key = false;
+	gdk_event_free(event); // also unrefs the window
+}
+
 sptr_t SS(SciObject *view, int message, uptr_t wparam, sptr_t lparam) {
-	return scintilla_send_message(SCINTILLA(view), message, wparam, lparam);
+	if (view != direct_view) // only look up cached values when switching views
+		direct_view = view,
+		direct_function = (SciFnDirect)(sptr_t)g_object_get_data(G_OBJECT(view), "direct_function"),
+		direct_pointer = (sptr_t)g_object_get_data(G_OBJECT(view), "direct_pointer");
+	return direct_function(direct_pointer, message, wparam, lparam);
 }
 
 void split_view(SciObject *view, SciObject *view2, bool vertical) {
@@ -283,7 +315,10 @@ bool unsplit_view(SciObject *view, void (*delete_view)(SciObject *view)) {
 	return (g_object_unref(view), g_object_unref(other), true);
 }
 
-void delete_scintilla(SciObject *view) { gtk_widget_destroy(view); }
+void delete_scintilla(SciObject *view) {
+	if (view == direct_view) direct_view = NULL; // a new view may reuse this address
+	gtk_widget_destroy(view);
+}
 
 Pane *get_top_pane(void) {
 	GtkWidget *pane = focused_view;
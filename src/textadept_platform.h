@@ -85,6 +85,13 @@ void set_size(int width, int height);
 SciObject *new_scintilla(void (*notified)(SciObject *, int, SCNotification *, void *));
 /** Signals the platform to focus the given Scintilla view. */
 void focus_view(SciObject *view);
+/** Asks the platform to send a keypress to the given Scintilla view as if the user pressed it.
+ * Textadept calls this when replaying a recorded "key" event that no handler handled.
+ * @param view The Scintilla view to send the keypress to.
+ * @param code The platform-specific key code that was passed to the "key" event.
+ * @param modifiers Bit-mask of `SCMOD_*` modifier keys that was passed to the "key" event.
+ */
+void send_key(SciObject *view, int code, int modifiers);
 /** Asks the platform to send a message to the given Scintilla view.
  * @param view The Scintilla view to send a message to.
  * @param message Message ID.
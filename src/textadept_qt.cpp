@@ -73,6 +73,8 @@ static int scModMask(const Qt::KeyboardModifiers &mods) {
 		(mods & Qt::MetaModifier ? SCMOD_META : 0);
 }
 
+static bool sendingKey; // whether or not send_key() is sending an already emitted keypress
+
 // Event filter for Scintilla views. This avoids the need to subclass ScintillaEditBase.
 class ScintillaEventFilter : public QObject {
 public:
@@ -85,8 +87,8 @@ protected:
 		if (event->type() == QEvent::FocusOut && SCI(watched) == SCI(command_entry))
 			return static_cast<QFocusEvent *>(event)->reason() == Qt::ActiveWindowFocusReason;
 
-		// Propagate non-keypress events as normal.
-		if (event->type() != QEvent::KeyPress) return false;
+		// Propagate non-keypress events and keypresses from send_key() as normal.
+		if (event->type() != QEvent::KeyPress || sendingKey) return false;
 
 		auto keyEvent = static_cast<QKeyEvent *>(event);
 
@@ -126,6 +128,18 @@ void focus_view(SciObject *view) {
 	QApplication::sendEvent(SCI(view), &event);
 }
 
+void send_key(SciObject *view, int code, int modifiers) {
+	Qt::KeyboardModifiers mods = {(modifiers & SCMOD_SHIFT ? Qt::ShiftModifier : Qt::NoModifier) |
+		(modifiers & SCMOD_CTRL ? Qt::ControlModifier : Qt::NoModifier) |
+		(modifiers & SCMOD_ALT ? Qt::AltModifier : Qt::NoModifier) |
+		(modifiers & SCMOD_META ? Qt::MetaModifier : Qt::NoModifier)};
+	// Qt key codes for characters are their upper-case Unicode code points.
+	QString text = code < 0x10000 ? QString{QChar{code}} : QString{};
+	if (!(modifiers & SCMOD_SHIFT)) text = text.toLower();
+	QKeyEvent event{QEvent::KeyPress, code, mods, text};
+	sendingKey = true, QApplication::sendEvent(SCI(view), &event), sendingKey = false;
+}
+
 sptr_t SS(SciObject *view, int message, uptr_t wparam, sptr_t lparam) {
 	return SCI(view)->send(message, wparam, lparam);
 }
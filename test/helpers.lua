@@ -252,8 +252,8 @@ function M.tmpdir(structure, chdir)
 	return dir
 end
 
---- Connects function *f* to event *event* at index *index* and returns a to-be-closed value
--- that disconnects *f* from *event*.
+--- Connects function *f* to event *event* at index *index* or with the given options, and
+-- returns a to-be-closed value that disconnects *f* from *event*.
 -- @see events.connect
 -- @return to-be-closed value
 -- @usage local _<close> = connect(event, f)
@@ -297,6 +297,28 @@ function M.mock(module, name, condition, mock)
 	return M.defer(function() module[name] = original_value end)
 end
 
+--- Returns the contents of a trace file for `events.replay()` that contains the given events.
+-- Each event is a list of an event name and its arguments, which may be booleans, numbers,
+-- or strings.
+function M.trace(...)
+	local records = {'TATRACE1'}
+	for _, event in ipairs{...} do
+		records[#records + 1] = string.pack('=dB', 0, #event)
+		for _, value in ipairs(event) do
+			if type(value) == 'string' then
+				records[#records + 1] = string.pack('=BI4', 4, #value) .. value
+			elseif math.type(value) == 'integer' then
+				records[#records + 1] = string.pack('=Bi8', 3, value)
+			elseif type(value) == 'number' then
+				records[#records + 1] = string.pack('=Bd', 0x80, value)
+			else
+				records[#records + 1] = string.pack('=BB', 1, value and 1 or 0)
+			end
+		end
+	end
+	return table.concat(records)
+end
+
 --- Sleep for *n* seconds.
 -- @param n Number of seconds to sleep for. It may be fractional.
 local function sleep(n) os.execute((not WIN32 and 'sleep ' or 'timeout /T ') .. n) end